@@ -47,6 +47,52 @@ LOCAL_MODULE_OWNER := intel
 
 include $(BUILD_HOST_STATIC_LIBRARY)
 
+#########################
+# utilities unit test host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libaudio_utilities_unit_test_host
+
+LOCAL_SRC_FILES := \
+    test/FileMapperUnitTest.cpp \
+    test/FileMapperRegistryUnitTest.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -ggdb3 -O0
+
+LOCAL_STATIC_LIBRARIES := \
+    libacresult_host
+
+LOCAL_STRIP_MODULE := false
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_NATIVE_TEST)
+
+#########################
+# utilities unit test target
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libaudio_utilities_unit_test
+
+LOCAL_SRC_FILES := \
+    test/FileMapperUnitTest.cpp \
+    test/FileMapperRegistryUnitTest.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -ggdb3 -O0
+
+LOCAL_STRIP_MODULE := false
+
+LOCAL_STATIC_LIBRARIES := \
+    libacresult
+
+include $(BUILD_NATIVE_TEST)
+
 # Recursive call sub-folder Android.mk
 #
 include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -24,7 +24,7 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)
 
-LOCAL_SRC_FILES := EventThread.cpp
+LOCAL_SRC_FILES := EventThread.cpp TimerWheel.cpp
 LOCAL_CFLAGS := -Wall -Werror -Wextra
 LOCAL_SHARED_LIBRARIES := libcutils
 LOCAL_STATIC_LIBRARIES := libaudio_utilities
@@ -42,7 +42,7 @@ include $(CLEAR_VARS)
 
 LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)
 
-LOCAL_SRC_FILES := EventThread.cpp
+LOCAL_SRC_FILES := EventThread.cpp TimerWheel.cpp
 LOCAL_STATIC_LIBRARIES := libaudio_utilities
 
 LOCAL_MODULE := libevent-listener_static
@@ -57,7 +57,7 @@ include $(BUILD_STATIC_LIBRARY)
 include $(CLEAR_VARS)
 
 LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)
-LOCAL_SRC_FILES := EventThread.cpp
+LOCAL_SRC_FILES := EventThread.cpp TimerWheel.cpp
 LOCAL_STATIC_LIBRARIES := libaudio_utilities_host
 
 LOCAL_MODULE := libevent-listener_static_host
@@ -67,3 +67,54 @@ LOCAL_MODULE_TAGS := optional
 include $(BUILD_HOST_STATIC_LIBRARY)
 
 
+# event listener unit test host
+###############################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libevent-listener_unit_test_host
+
+LOCAL_SRC_FILES := \
+    test/EventThreadUnitTest.cpp \
+    test/TimerWheelUnitTest.cpp
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -ggdb3 -O0
+
+LOCAL_STATIC_LIBRARIES := \
+    libevent-listener_static_host \
+    libaudio_utilities_host
+
+LOCAL_SHARED_LIBRARIES := liblog
+
+# Leaks of the event thread are reported by the address sanitizer
+LOCAL_SANITIZE := address
+
+LOCAL_STRIP_MODULE := false
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_NATIVE_TEST)
+
+# event listener unit test target
+#################################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libevent-listener_unit_test
+
+LOCAL_SRC_FILES := \
+    test/EventThreadUnitTest.cpp \
+    test/TimerWheelUnitTest.cpp
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -ggdb3 -O0
+
+LOCAL_STRIP_MODULE := false
+
+LOCAL_STATIC_LIBRARIES := \
+    libevent-listener_static \
+    libaudio_utilities
+
+LOCAL_SHARED_LIBRARIES := libcutils
+
+include $(BUILD_NATIVE_TEST)
+
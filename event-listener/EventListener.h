@@ -30,6 +30,31 @@ public:
      */
     virtual bool onEvent(int fd) = 0;
 
+    /**
+     * Callback upon read event on a given file descriptor, with the context given when adding
+     * it to the event thread. Calls onEvent by default, listeners that do not need the context
+     * do not need to implement it.
+     *
+     * @param[in] fd on which the event was detected.
+     * @param[in] context pointer given by the client of the event thread through addOpenedFd.
+     *                    Note that is may be NULL.
+     *
+     * @return true if the list of file descripter polled has changed, false otherwise.
+     */
+    virtual bool onReadable(int fd, void * /*context*/) { return onEvent(fd); }
+
+    /**
+     * Callback upon write event on a given file descriptor, polled for writing with
+     * CEventThread::setFdInterest. Listeners that do not write do not need to implement it.
+     *
+     * @param[in] fd on which the event was detected.
+     * @param[in] context pointer given by the client of the event thread through addOpenedFd.
+     *                    Note that is may be NULL.
+     *
+     * @return true if the list of file descripter polled has changed, false otherwise.
+     */
+    virtual bool onWritable(int /*fd*/, void * /*context*/) { return false; }
+
     /**
      * Callback upon an error event on a given file descriptor.
      *
@@ -54,6 +79,16 @@ public:
      */
     virtual void onAlarm() = 0;
 
+    /**
+     * Callback upon expiration of a timer started on the event thread. Listeners that do not
+     * start timers do not need to implement it.
+     *
+     * @param[in] timerId identifier of the timer returned by startTimer.
+     * @param[in] context pointer that was given by the client of the event thread through
+     *                    startTimer. Note that is may be NULL.
+     */
+    virtual void onTimer(uint32_t /*timerId*/, void * /*context*/) {}
+
     /**
      * Callback upon read event on a given file descriptor.
      */
@@ -21,89 +21,275 @@
 
 #include "EventThread.h"
 #include <AudioUtilitiesAssert.hpp>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
-#include <strings.h>
 #include <string.h>
 #include <time.h>
 #include <errno.h>
 
 const int64_t MILLISECONDS_IN_SECONDS = 1000;
 const int64_t NANOSECONDS_IN_MILLISECONDS = 1000 * 1000;
+const int MAX_EPOLL_EVENTS = 64; /**< Ready file descriptors reported per epoll wakeup. */
 
 #define SECONDS_TO_MILLISECONDS(seconds)            (int32_t(seconds) * MILLISECONDS_IN_SECONDS)
 #define NANOSECONDS_TO_MILLISECONDS(nanoseconds)    ((nanoseconds) / NANOSECONDS_IN_MILLISECONDS)
 
-CEventThread::CEventThread(IEventListener *eventListener, bool logsOn)
+/**
+ * Translate epoll events into their poll equivalents.
+ */
+static short epollToPollEvents(uint32_t epollEvents)
+{
+    short pollEvents = 0;
+    if (epollEvents & EPOLLIN) {
+        pollEvents |= POLLIN;
+    }
+    if (epollEvents & EPOLLPRI) {
+        pollEvents |= POLLPRI;
+    }
+    if (epollEvents & EPOLLOUT) {
+        pollEvents |= POLLOUT;
+    }
+    if (epollEvents & EPOLLERR) {
+        pollEvents |= POLLERR;
+    }
+    if (epollEvents & EPOLLHUP) {
+        pollEvents |= POLLHUP;
+    }
+    return pollEvents;
+}
+
+/**
+ * Translate a file descriptor interest into the poll events to poll for.
+ */
+static short interestToPollEvents(uint32_t interest)
+{
+    short pollEvents = 0;
+    if (interest & CEventThread::EReadable) {
+        pollEvents |= POLLIN;
+    }
+    if (interest & CEventThread::EPriority) {
+        pollEvents |= POLLPRI;
+    }
+    if (interest & CEventThread::EWritable) {
+        pollEvents |= POLLOUT;
+    }
+    return pollEvents;
+}
+
+/**
+ * Translate a file descriptor interest into the epoll events to poll for.
+ */
+static uint32_t interestToEpollEvents(uint32_t interest)
+{
+    uint32_t epollEvents = 0;
+    if (interest & CEventThread::EReadable) {
+        epollEvents |= EPOLLIN;
+    }
+    if (interest & CEventThread::EPriority) {
+        epollEvents |= EPOLLPRI;
+    }
+    if (interest & CEventThread::EWritable) {
+        epollEvents |= EPOLLOUT;
+    }
+    if (interest & CEventThread::EEdgeTriggered) {
+        epollEvents |= EPOLLET;
+    }
+    if (interest & CEventThread::EOneShot) {
+        epollEvents |= EPOLLONESHOT;
+    }
+    return epollEvents;
+}
+
+CEventThread::CEventThread(IEventListener *eventListener, bool logsOn, PollBackend backend)
     : mEventListener(eventListener),
       mIsStarted(false),
       mThreadId(0),
-      mNbPollFds(0),
+      mDoorbellFd(-1),
+      mMailbox(NULL),
+      mEpollFd(-1),
+      mDoorbellHandle(0),
       mAlarmMs(-1),
+      mTimerWheel(getCurrentDateMs()),
       mLogsOn(logsOn)
 {
     AUDIOUTILITIES_ASSERT(eventListener, "Invalid event listener");
 
-    // Create inband pipe
-    pipe(mInbandPipe);
+    if (backend == EEpollBackend) {
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        AUDIOUTILITIES_ASSERT(mEpollFd >= 0, "Unable to create epoll instance: "
+                              << strerror(errno));
+    }
 
-    // Add to poll fds
-    addOpenedFd(-1, mInbandPipe[0], true);
+    // Create mailbox doorbell, non blocking as the mailbox may be drained without it
+    mDoorbellFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    AUDIOUTILITIES_ASSERT(mDoorbellFd >= 0, "Unable to create doorbell: " << strerror(errno));
+
+    // Add to poll fds, first of the polled fds
+    mDoorbellHandle = registerFd(mDoorbellFd, EReadable, NULL);
 }
 
 CEventThread::~CEventThread()
 {
     stop();
 
-    close(mInbandPipe[0]);
-    close(mInbandPipe[1]);
+    close(mDoorbellFd);
+
+    // Messages posted after the exit request are dropped
+    Message *message = takeMessages();
+    while (message != NULL) {
+        Message *next = message->next;
+        delete message;
+        message = next;
+    }
+
+    if (mEpollFd >= 0) {
+        close(mEpollFd);
+    }
 }
 
-void CEventThread::addOpenedFd(uint32_t fdClientId, int fd, bool toListenTo)
+void CEventThread::addOpenedFd(uint32_t fdClientId, int fd, bool toListenTo, void *context)
 {
     AUDIOUTILITIES_ASSERT(!mIsStarted || inThreadContext(), "Operation invalid within this context");
+    AUDIOUTILITIES_ASSERT(mHandles.find(fdClientId) == mHandles.end(),
+                          "Client Fd id " << fdClientId << " already used");
 
-    mFdList.push_back(SFd(fdClientId, fd, toListenTo));
+    mHandles[fdClientId] = registerFd(fd, toListenTo ? EReadable : 0, context);
+}
 
-    if (toListenTo) {
-        // Keep track of number of polled Fd
-        mNbPollFds++;
-    }
+void CEventThread::setFdInterest(uint32_t clientFdId, uint32_t interest)
+{
+    AUDIOUTILITIES_ASSERT(!mIsStarted || inThreadContext(), "Operation invalid within this context");
+
+    HandleMapConstIterator it = mHandles.find(clientFdId);
+    AUDIOUTILITIES_ASSERT(it != mHandles.end(), "Unknown client Fd id " << clientFdId);
+
+    applyFdInterest(it->second, interest);
 }
 
 void CEventThread::closeAndRemoveFd(uint32_t ClientFdId)
 {
     AUDIOUTILITIES_ASSERT(!mIsStarted || inThreadContext(), "Operation invalid within this context");
 
-    FdListIterator it;
-    for (it = mFdList.begin(); it != mFdList.end(); ++it) {
-        const SFd *fd = &(*it);
+    HandleMapIterator it = mHandles.find(ClientFdId);
+    if (it == mHandles.end()) {
+        return;
+    }
+    int fd = mFds[it->second].mFd;
 
-        if (fd->mClientFdId == ClientFdId) {
-            close(fd->mFd);
+    // Unregister before closing, the file may be shared with an other fd
+    unregisterFd(it->second);
+    mHandles.erase(it);
+    close(fd);
+}
 
-            if (fd->mToListenTo) {
-                // Keep track of number of polled Fd
-                mNbPollFds--;
-            }
-            mFdList.erase(it);
-            return;
-        }
+int CEventThread::getFd(uint32_t clientFdId) const
+{
+    HandleMapConstIterator it = mHandles.find(clientFdId);
+
+    if (it != mHandles.end()) {
+        return mFds[it->second].mFd;
     }
+    ALOGD_IF(mLogsOn, "%s: Could not find File descriptor from List", __func__);
+    return -1;
 }
 
-int CEventThread::getFd(uint32_t clientFdId) const
+uint32_t CEventThread::registerFd(int fd, uint32_t interest, void *context)
+{
+    uint32_t handle;
+    if (mFreeHandles.empty()) {
+        handle = mFds.size();
+        mFds.push_back(SFd());
+        mFds[handle].mGeneration = 0;
+    } else {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+    }
+    SFd &registration = mFds[handle];
+    registration.mFd = fd;
+    registration.mGeneration++;
+    registration.mInterest = 0;
+    registration.mContext = context;
+    registration.mInEpoll = false;
+
+    if (mEpollFd < 0) {
+        // All registered fds have a poll entry, so that changing the interest of a fd does not
+        // change the list of polled fds
+        struct pollfd pollFd;
+        pollFd.fd = -1;
+        pollFd.events = 0;
+        pollFd.revents = 0;
+
+        registration.mPollIndex = mPollFds.size();
+        mPollFds.push_back(pollFd);
+        mPollHandles.push_back(handle);
+    }
+    applyFdInterest(handle, interest);
+    return handle;
+}
+
+void CEventThread::unregisterFd(uint32_t handle)
+{
+    applyFdInterest(handle, 0);
+
+    if (mEpollFd < 0) {
+        // Replace by the last poll fd, the doorbell staying the first one
+        uint32_t index = mFds[handle].mPollIndex;
+        uint32_t lastHandle = mPollHandles.back();
+
+        mPollFds[index] = mPollFds.back();
+        mPollHandles[index] = lastHandle;
+        mFds[lastHandle].mPollIndex = index;
+        mPollFds.pop_back();
+        mPollHandles.pop_back();
+    }
+    mFds[handle].mFd = -1;
+    mFreeHandles.push_back(handle);
+}
+
+void CEventThread::applyFdInterest(uint32_t handle, uint32_t interest)
 {
-    FdListConstIterator it;
+    SFd &registration = mFds[handle];
+    registration.mInterest = interest;
 
-    for (it = mFdList.begin(); it != mFdList.end(); ++it) {
-        const SFd *pFd = &(*it);
+    if (mEpollFd < 0) {
+        AUDIOUTILITIES_ASSERT(!(interest & EEdgeTriggered),
+                              "Edge triggered interest requires the epoll backend");
 
-        if (pFd->mClientFdId == clientFdId) {
-            return pFd->mFd;
+        // poll ignores negative fds
+        struct pollfd &pollFd = mPollFds[registration.mPollIndex];
+        pollFd.fd = (interest & EEvents) ? registration.mFd : -1;
+        pollFd.events = interestToPollEvents(interest);
+        return;
+    }
+    if (!(interest & EEvents)) {
+        if (registration.mInEpoll) {
+            epoll_ctl(mEpollFd, EPOLL_CTL_DEL, registration.mFd, NULL);
+            registration.mInEpoll = false;
         }
+        return;
     }
-    ALOGD_IF(mLogsOn, "%s: Could not find File descriptor from List", __func__);
-    return -1;
+    // The handle and its generation are given back with the events, instead of the fd
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = interestToEpollEvents(interest);
+    event.data.u64 = (uint64_t(registration.mGeneration) << 32) | handle;
+    int ret = epoll_ctl(mEpollFd, registration.mInEpoll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                        registration.mFd, &event);
+    AUDIOUTILITIES_ASSERT(ret == 0, "Unable to poll Fd (" << registration.mFd << ") with epoll: "
+                          << strerror(errno));
+    registration.mInEpoll = true;
+}
+
+void CEventThread::disarmFd(uint32_t handle)
+{
+    SFd &registration = mFds[handle];
+    registration.mInterest &= ~EEvents;
+
+    if (mEpollFd < 0) {
+        mPollFds[registration.mPollIndex].fd = -1;
+    }
+    // epoll disarms one-shot fds itself, they are rearmed by EPOLL_CTL_MOD
 }
 
 void CEventThread::startAlarm(uint32_t durationMs)
@@ -119,6 +305,20 @@ void CEventThread::cancelAlarm()
     mAlarmMs = -1;
 }
 
+uint32_t CEventThread::startTimer(uint32_t durationMs, uint32_t periodMs, void *context)
+{
+    AUDIOUTILITIES_ASSERT(!mIsStarted || inThreadContext(), "Operation invalid within this context");
+
+    return mTimerWheel.start(getCurrentDateMs(), durationMs, periodMs, context);
+}
+
+bool CEventThread::cancelTimer(uint32_t timerId)
+{
+    AUDIOUTILITIES_ASSERT(!mIsStarted || inThreadContext(), "Operation invalid within this context");
+
+    return mTimerWheel.cancel(timerId);
+}
+
 bool CEventThread::start()
 {
     AUDIOUTILITIES_ASSERT(!mIsStarted, "Event thread already started");
@@ -135,18 +335,7 @@ void CEventThread::stop()
     }
 
     // Cause exiting of the thread
-    Message toWrite;
-    toWrite.eventId = 0;
-    toWrite.context = NULL;
-    toWrite.msg = EExit;
-
-    ssize_t ret;
-    do {
-        ret = ::write(mInbandPipe[1], &toWrite, sizeof(toWrite));
-    } while (ret == -1 && errno == EINTR);
-    AUDIOUTILITIES_ASSERT(ret == sizeof(toWrite),
-                      "Unable to write message in pipe: ret: "
-                      << ret << " status: " << strerror(errno));
+    postMessage(EExit, NULL, 0);
 
     pthread_join(mThreadId, NULL);
     mIsStarted = false;
@@ -158,18 +347,7 @@ void CEventThread::trig(void *context, uint32_t eventId /* = -1 */)
 
     AUDIOUTILITIES_ASSERT(mIsStarted, "Event thread not started");
 
-    Message toWrite;
-    toWrite.eventId = eventId;
-    toWrite.context = context;
-    toWrite.msg = EProcess;
-
-    ssize_t ret;
-    do {
-        ret = ::write(mInbandPipe[1], &toWrite, sizeof(toWrite));
-    } while (ret == -1 && errno == EINTR);
-    AUDIOUTILITIES_ASSERT(ret == sizeof(toWrite),
-                      "Unable to write message in pipe: ret: "
-                      << ret << " status: " << strerror(errno));
+    postMessage(EProcess, context, eventId);
 
     ALOGD_IF(mLogsOn, "%s: out", __func__);
 }
@@ -188,114 +366,246 @@ void *CEventThread::thread_func(void *data)
 void CEventThread::run()
 {
     while (true) {
-        // Rebuild polled FDs
-        struct pollfd pollFds[mNbPollFds];
-
-        buildPollFds(pollFds);
-
-        /// Poll
-        int timeoutMs = -1;
-        // Compute the poll timeout regarding the alarm
-        if (mAlarmMs >= 0) {
-            // Get current time in milliseconds
-            int64_t now = getCurrentDateMs();
-
-            // Future ?
-            if (mAlarmMs > now) {
-                timeoutMs = (int)(mAlarmMs - now);
-            } else {
-                timeoutMs = 0;
-            }
+        // Report the expired timers
+        mTimerWheel.advance(getCurrentDateMs(), mEventListener);
+
+        int timeoutMs = getPollTimeoutMs();
 
-        }
         // Do poll
         ALOGD("%s Do poll with timeout: %d", __func__, timeoutMs);
-        int pollResult = poll(pollFds, mNbPollFds, timeoutMs);
+        bool goOn = mEpollFd >= 0 ? epollAndDispatch(timeoutMs) : pollAndDispatch(timeoutMs);
+
+        if (!goOn) {
+            ALOGD_IF(mLogsOn, "%s exit", __func__);
+            return;
+        }
+    }
+}
+
+int CEventThread::getPollTimeoutMs() const
+{
+    int64_t wakeupMs = mTimerWheel.getNextWakeupMs();
+    if (mAlarmMs >= 0 && (wakeupMs < 0 || mAlarmMs < wakeupMs)) {
+        wakeupMs = mAlarmMs;
+    }
+    if (wakeupMs < 0) {
+        return -1;
+    }
+    // Get current time in milliseconds
+    int64_t now = getCurrentDateMs();
+
+    // Future ?
+    return wakeupMs > now ? (int)(wakeupMs - now) : 0;
+}
+
+bool CEventThread::isAlarmDue() const
+{
+    return mAlarmMs >= 0 && mAlarmMs <= getCurrentDateMs();
+}
 
-        if (!pollResult) {
-            // Timeout case
+bool CEventThread::pollAndDispatch(int timeoutMs)
+{
+    int pollResult = poll(&mPollFds[0], mPollFds.size(), timeoutMs);
+
+    if (!pollResult) {
+        // Timeout case, expired timers are reported by the run loop
+        if (isAlarmDue()) {
             mEventListener->onAlarm();
-            continue;
         }
-        if (pollResult < 0) {
-            // I/O error?
-            mEventListener->onPollError();
-            continue;
+        return true;
+    }
+    if (pollResult < 0) {
+        // I/O error?
+        mEventListener->onPollError();
+        return true;
+    }
+    if (mPollFds[0].revents & POLLIN) {
+        bool fdListChanged;
+        if (!processInbandMessages(fdListChanged)) {
+            return false;
         }
-        if (pollFds[0].revents & POLLIN) {
-            // Consume request
-            Message dataRead;
-            ssize_t ret;
-            do {
-                ret = ::read(mInbandPipe[0], &dataRead, sizeof(dataRead));
-            } while (ret == -1 && errno == EINTR);
-            AUDIOUTILITIES_ASSERT(ret == sizeof(dataRead),
-                              "Unable to write message in pipe: ret: "
-                              << ret << " status: " << strerror(errno));
-            AUDIOUTILITIES_ASSERT(dataRead.msg < ENbPipeMsg, "Invalid message in pipe");
-
-            if (dataRead.msg == EProcess) {
-                if (mEventListener->onProcess(dataRead.context, dataRead.eventId)) {
-                    continue;
-                }
-            } else {
-                ALOGD_IF(mLogsOn, "%s exit", __func__);
-                return;
-            }
+        if (fdListChanged) {
+            return true;
+        }
+    }
+    uint32_t index;
+    for (index = 1; index < mPollFds.size(); index++) {
+        if (mPollFds[index].revents != 0 &&
+            dispatchFdEvents(mPollHandles[index], mPollFds[index].revents)) {
+            // FD list has changed, bail out
+            break;
+        }
+    }
+    return true;
+}
+
+bool CEventThread::epollAndDispatch(int timeoutMs)
+{
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+
+    int readyNb = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS, timeoutMs);
+
+    if (!readyNb) {
+        // Timeout case, expired timers are reported by the run loop
+        if (isAlarmDue()) {
+            mEventListener->onAlarm();
         }
-        {
-            uint32_t index;
-            for (index = 1; index < mNbPollFds; index++) {
-                // Check for errors first and reports to the listener
-                if (pollFds[index].revents & POLLERR) {
-                    ALOGD_IF(mLogsOn, "%s POLLERR event on Fd (%d)", __func__, index);
-
-                    if (mEventListener->onError(pollFds[index].fd)) {
-                        // FD list has changed, bail out
-                        break;
-                    }
-                }
-                // Check for hang ups and reports to the listener
-                if (pollFds[index].revents & POLLHUP) {
-                    ALOGD_IF(mLogsOn, "%s POLLHUP event on Fd (%d)", __func__, index);
-
-                    if (mEventListener->onHangup(pollFds[index].fd)) {
-                        // FD list has changed, bail out
-                        break;
-                    }
-                }
-                // Check for read events and reports to the listener
-                if (pollFds[index].revents & POLLIN) {
-                    ALOGD_IF(mLogsOn, "%s POLLIN event on Fd (%d)", __func__, index);
-
-                    if (mEventListener->onEvent(pollFds[index].fd)) {
-                        // FD list has changed, bail out
-                        break;
-                    }
-                }
+        return true;
+    }
+    if (readyNb < 0) {
+        // I/O error?
+        mEventListener->onPollError();
+        return true;
+    }
+    // As with poll, inband messages are processed before the events of the other Fds
+    int index;
+    for (index = 0; index < readyNb; index++) {
+        if (uint32_t(events[index].data.u64) == mDoorbellHandle &&
+            (events[index].events & EPOLLIN)) {
+            // Fds removed or added are filtered below
+            bool fdListChanged;
+            if (!processInbandMessages(fdListChanged)) {
+                return false;
             }
         }
     }
+    // Unlike poll, the whole batch is dispatched even if the FD list changes: edge triggered
+    // and one-shot events would not be reported again. The events of fds removed since the
+    // wakeup, whose handle may have been reused, are skipped.
+    for (index = 0; index < readyNb; index++) {
+        uint32_t handle = uint32_t(events[index].data.u64);
+        uint32_t generation = uint32_t(events[index].data.u64 >> 32);
+
+        if (handle == mDoorbellHandle || mFds[handle].mFd < 0 ||
+            mFds[handle].mGeneration != generation) {
+            continue;
+        }
+        dispatchFdEvents(handle, epollToPollEvents(events[index].events));
+    }
+    return true;
 }
 
-void CEventThread::buildPollFds(struct pollfd *pollFds) const
+void CEventThread::postMessage(InbandMsg msg, void *context, uint32_t eventId)
 {
-    // Reset memory
-    bzero(pollFds, sizeof(struct pollfd) * mNbPollFds);
+    Message *message = new Message;
+    message->context = context;
+    message->eventId = eventId;
+    message->msg = msg;
+
+    // Push on the mailbox stack, released for the event thread to read the message.
+    // Once pushed, the message belongs to the event thread: it is no longer accessed.
+    Message *previous = __atomic_load_n(&mMailbox, __ATOMIC_RELAXED);
+    do {
+        message->next = previous;
+    } while (!__atomic_compare_exchange_n(&mMailbox, &previous, message, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    if (previous != NULL) {
+        // Doorbell already rung by the first message of the mailbox
+        return;
+    }
+    uint64_t ring = 1;
+    ssize_t ret;
+    do {
+        ret = ::write(mDoorbellFd, &ring, sizeof(ring));
+    } while (ret == -1 && errno == EINTR);
+    AUDIOUTILITIES_ASSERT(ret == sizeof(ring),
+                      "Unable to ring doorbell: ret: "
+                      << ret << " status: " << strerror(errno));
+}
 
-    // Fill
-    uint32_t fdIndex = 0;
-    FdListConstIterator it;
+CEventThread::Message *CEventThread::takeMessages()
+{
+    Message *stack = __atomic_exchange_n(&mMailbox, (Message *)NULL, __ATOMIC_ACQUIRE);
+
+    // Reverse the stack to get the messages in the order they were posted
+    Message *messages = NULL;
+    while (stack != NULL) {
+        Message *next = stack->next;
+        stack->next = messages;
+        messages = stack;
+        stack = next;
+    }
+    return messages;
+}
 
-    for (it = mFdList.begin(); it != mFdList.end(); ++it) {
-        const SFd *fd = &(*it);
+bool CEventThread::processInbandMessages(bool &fdListChanged)
+{
+    // Acknowledge the doorbell before draining, messages posted from now on ring it again
+    uint64_t ringNb;
+    ssize_t ret;
+    do {
+        ret = ::read(mDoorbellFd, &ringNb, sizeof(ringNb));
+    } while (ret == -1 && errno == EINTR);
+    AUDIOUTILITIES_ASSERT(ret == sizeof(ringNb) || errno == EAGAIN,
+                      "Unable to read doorbell: ret: "
+                      << ret << " status: " << strerror(errno));
 
-        if (fd->mToListenTo) {
-            pollFds[fdIndex].fd = fd->mFd;
-            pollFds[fdIndex++].events = POLLIN;
+    fdListChanged = false;
+    bool exit = false;
+    Message *message = takeMessages();
+    while (message != NULL) {
+        AUDIOUTILITIES_ASSERT(message->msg < ENbInbandMsg, "Invalid message in mailbox");
+
+        // Messages following an exit request are dropped
+        if (message->msg == EExit) {
+            exit = true;
+        } else if (!exit && mEventListener->onProcess(message->context, message->eventId)) {
+            fdListChanged = true;
         }
+        Message *next = message->next;
+        delete message;
+        message = next;
+    }
+    return !exit;
+}
+
+bool CEventThread::dispatchFdEvents(uint32_t handle, short revents)
+{
+    // Copied, the listener may register fds
+    int fd = mFds[handle].mFd;
+    void *context = mFds[handle].mContext;
+    uint32_t interest = mFds[handle].mInterest;
+
+    if (!(interest & EEvents)) {
+        // No longer polled since the wakeup
+        return false;
+    }
+    if (interest & EOneShot) {
+        // Before reporting, for the listener to poll the fd again
+        disarmFd(handle);
+    }
+
+    // Check for errors first and reports to the listener
+    if (revents & POLLERR) {
+        ALOGD_IF(mLogsOn, "%s POLLERR event on Fd (%d)", __func__, fd);
+
+        if (mEventListener->onError(fd)) {
+            return true;
+        }
+    }
+    // Check for hang ups and reports to the listener
+    if (revents & POLLHUP) {
+        ALOGD_IF(mLogsOn, "%s POLLHUP event on Fd (%d)", __func__, fd);
+
+        if (mEventListener->onHangup(fd)) {
+            return true;
+        }
+    }
+    // Check for read events and reports to the listener
+    if ((revents & (POLLIN | POLLPRI)) && (interest & (EReadable | EPriority))) {
+        ALOGD_IF(mLogsOn, "%s POLLIN event on Fd (%d)", __func__, fd);
+
+        if (mEventListener->onReadable(fd, context)) {
+            return true;
+        }
+    }
+    // Check for write events and reports to the listener
+    if ((revents & POLLOUT) && (interest & EWritable)) {
+        ALOGD_IF(mLogsOn, "%s POLLOUT event on Fd (%d)", __func__, fd);
+
+        return mEventListener->onWritable(fd, context);
     }
-    AUDIOUTILITIES_ASSERT(fdIndex == mNbPollFds, "Inconsistent list of file descriptor to poll");
+    return false;
 }
 
 int64_t CEventThread::getCurrentDateMs()
@@ -20,7 +20,9 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <stddef.h>
-#include <list>
+#include <map>
+#include <vector>
+#include "TimerWheel.h"
 
 using namespace std;
 
@@ -29,12 +31,12 @@ class IEventListener;
 class CEventThread
 {
 private:
-    enum PipeMsg
+    enum InbandMsg
     {
         EProcess,
         EExit,
 
-        ENbPipeMsg
+        ENbInbandMsg
     };
 
     struct Message
@@ -42,22 +44,63 @@ private:
         void *context;
         uint32_t eventId;
         uint32_t msg;
+        Message *next; /**< Message posted before this one. */
     };
 
+    /**
+     * File descriptor registration, identified by its handle: its index in the table of
+     * registrations. The handle is given back with the events of the file descriptor, so that
+     * dispatching needs no lookup.
+     */
     struct SFd
     {
-        SFd(uint32_t clientFdId, int fd,
-            bool toListenTo) : mClientFdId(clientFdId), mFd(fd), mToListenTo(toListenTo) {}
-        uint32_t mClientFdId;
-        int mFd;
-        bool mToListenTo;
+        int mFd; /**< File descriptor, -1 if the registration is free. */
+        uint32_t mGeneration; /**< Changed at each registration, given back with the handle by
+                               *   epoll to tell the events of a previous use of the handle. */
+        uint32_t mInterest; /**< Bit field of FdInterest, without event once a one-shot fired. */
+        void *mContext; /**< Client pointer given back with the read and write events. */
+        uint32_t mPollIndex; /**< Index in the poll file descriptors (poll backend). */
+        bool mInEpoll; /**< Added to the epoll instance (epoll backend). */
     };
 
-    typedef list<SFd>::iterator FdListIterator;
-    typedef list<SFd>::const_iterator FdListConstIterator;
+    typedef map<uint32_t, uint32_t>::iterator HandleMapIterator;
+    typedef map<uint32_t, uint32_t>::const_iterator HandleMapConstIterator;
 
 public:
-    CEventThread(IEventListener *eventListener, bool bLogsOn = true);
+    /**
+     * Mechanism used to wait for events on the polled file descriptors.
+     */
+    enum PollBackend
+    {
+        EPollBackend, /**< poll(), the polled file descriptors are given at each wakeup. */
+        EEpollBackend /**< epoll, file descriptors are registered once, the wakeup cost
+                       *   depends on the ready file descriptors only. */
+    };
+
+    /**
+     * Events a file descriptor is polled for, and how.
+     */
+    enum FdInterest
+    {
+        EReadable = 1 << 0, /**< Reported by onReadable. */
+        EWritable = 1 << 1, /**< Reported by onWritable. */
+        EPriority = 1 << 2, /**< Priority data to read, reported by onReadable. */
+        EEdgeTriggered = 1 << 3, /**< Events reported once per state change, the client has to
+                                  *   read or write until EAGAIN. Requires the epoll backend. */
+        EOneShot = 1 << 4, /**< Fd no longer polled after its first event, until its interest
+                            *   is set again. */
+
+        EEvents = EReadable | EWritable | EPriority
+    };
+
+    /**
+     * @param[in] eventListener listener to report events to.
+     * @param[in] bLogsOn initial state of the event thread logs.
+     * @param[in] backend mechanism used to wait for events, epoll being preferred
+     *                    when many file descriptors are polled.
+     */
+    CEventThread(IEventListener *eventListener, bool bLogsOn = true,
+                 PollBackend backend = EPollBackend);
     ~CEventThread();
 
     /**
@@ -66,9 +109,22 @@ public:
      *
      * @param[in] fdClientId identifier given by the client associated to this fd to poll.
      * @param[in] fd file descriptor to add to the list.
-     * @param[in] toListenTo indicates if the client expects to poll on this file descriptor.
+     * @param[in] toListenTo indicates if the client expects to poll on this file descriptor
+     *                       for read events. Other events can be polled with setFdInterest.
+     * @param[in] context pointer given back through onReadable and onWritable.
+     *                    Note that is may be NULL.
      */
-    void addOpenedFd(uint32_t fdClientId, int fd, bool toListenTo = false);
+    void addOpenedFd(uint32_t fdClientId, int fd, bool toListenTo = false, void *context = NULL);
+
+    /**
+     * Change the events a file descriptor is polled for
+     * (must be called from the EventThread thread context when started).
+     * Changing the interest does not change the list of file descriptors polled.
+     *
+     * @param[in] clientFdId client file descriptor Id.
+     * @param[in] interest bit field of FdInterest, without event to stop polling the fd.
+     */
+    void setFdInterest(uint32_t clientFdId, uint32_t interest);
 
     /**
      * Get File descriptor associated to a client File Descriptor Id.
@@ -104,6 +160,29 @@ public:
      */
     void cancelAlarm();
 
+    /**
+     * Start a timer which will trig onTimer() in durationMs from now, then every periodMs if
+     * periodic. Any number of timers can run concurrently.
+     * (must be called from the EventThread thread context when started).
+     *
+     * @param[in] durationMs duration in milliseconds to wait before onTimer callback is called.
+     * @param[in] periodMs period in milliseconds of the following onTimer calls, 0 for a one-shot
+     *                     timer.
+     * @param[in] context pointer given back through onTimer. Note that it may be NULL.
+     *
+     * @return identifier of the timer, given back through onTimer.
+     */
+    uint32_t startTimer(uint32_t durationMs, uint32_t periodMs = 0, void *context = NULL);
+
+    /**
+     * Cancel a timer (must be called from the EventThread thread context when started).
+     *
+     * @param[in] timerId identifier returned by startTimer.
+     *
+     * @return true if the timer was cancelled, false if it had already expired or been cancelled.
+     */
+    bool cancelTimer(uint32_t timerId);
+
     /**
      * Start the event thread service.
      *
@@ -118,7 +197,7 @@ public:
 
     /**
      * Returns the state of the event thread. When started, i.e. the event thread is listening
-     * to event from its list of file descriptor and from its pipe, no file descriptor can be
+     * to event from its list of file descriptor and from its mailbox, no file descriptor can be
      * added outside the context of the event thread. The only way to change this list is to append
      * remove file descriptor upon call back of the event thread and returning true to notify
      * of the change.
@@ -170,25 +249,104 @@ private:
     void run();
 
     /**
-     * Add a file descriptor to the list of polled file descriptors.
+     * Compute the poll timeout regarding the alarm and the timers.
+     *
+     * @return timeout in milliseconds, -1 if neither alarm nor timer is set.
+     */
+    int getPollTimeoutMs() const;
+
+    /**
+     * @return true if the alarm is set and its date is reached, false otherwise.
+     */
+    bool isAlarmDue() const;
+
+    /**
+     * Wait for events with poll and dispatch them.
+     *
+     * @param[in] timeoutMs poll timeout in milliseconds.
+     *
+     * @return false if the event thread has to exit, true otherwise.
+     */
+    bool pollAndDispatch(int timeoutMs);
+
+    /**
+     * Wait for events with epoll and dispatch them.
+     *
+     * @param[in] timeoutMs epoll timeout in milliseconds.
+     *
+     * @return false if the event thread has to exit, true otherwise.
+     */
+    bool epollAndDispatch(int timeoutMs);
+
+    /**
+     * Post a message to the event thread mailbox, from any thread.
+     * The doorbell is only rung if the mailbox was empty: otherwise the event thread
+     * has already been woken up and has not drained the mailbox yet.
+     *
+     * @param[in] msg type of the message.
+     * @param[in] context pointer given by the client of the event thread.
+     * @param[in] eventId given by the client of the event thread.
+     */
+    void postMessage(InbandMsg msg, void *context, uint32_t eventId);
+
+    /**
+     * Consume and process all the messages of the mailbox, in the order they were posted.
+     *
+     * @param[out] fdListChanged true if the list of file descriptors polled has changed.
+     *
+     * @return false if the event thread has to exit, true otherwise.
+     */
+    bool processInbandMessages(bool &fdListChanged);
+
+    /**
+     * Take all the messages of the mailbox.
+     *
+     * @return the messages in the order they were posted, the first one pointing to the next.
+     */
+    Message *takeMessages();
+
+    /**
+     * Report the events detected on a polled file descriptor to the listener.
+     *
+     * @param[in] handle of the file descriptor on which the events were detected.
+     * @param[in] revents poll events detected.
+     *
+     * @return true if the list of file descriptors polled has changed, false otherwise.
+     */
+    bool dispatchFdEvents(uint32_t handle, short revents);
+
+    /**
+     * Register a file descriptor in a free entry of the table.
+     *
+     * @param[in] fd file descriptor to register.
+     * @param[in] interest bit field of FdInterest.
+     * @param[in] context pointer given back through onReadable and onWritable.
+     *
+     * @return handle of the registration.
+     */
+    uint32_t registerFd(int fd, uint32_t interest, void *context);
+
+    /**
+     * Free the registration of a file descriptor, its handle being reused by the next one.
      *
-     * @param[in] fd to add.
+     * @param[in] handle of the registration.
      */
-    void addListenedFd(int fd);
+    void unregisterFd(uint32_t handle);
 
     /**
-     * Remove a file descriptor from the list of polled file descriptors.
+     * Apply the interest of a registered file descriptor to the poll or epoll file descriptors.
      *
-     * @param[in] fd to remove.
+     * @param[in] handle of the file descriptor.
+     * @param[in] interest bit field of FdInterest.
      */
-    void removeListenedFd(int fd);
+    void applyFdInterest(uint32_t handle, uint32_t interest);
 
     /**
-     * Rebuild the list of file descriptors to be polled.
+     * Stop polling a file descriptor after its one-shot event, until its interest is set again.
      *
-     * @param[in]
+     * @param[in] handle of the file descriptor.
      */
-    void buildPollFds(struct pollfd *pollFds) const;
+    void disarmFd(uint32_t handle);
 
     /**
      * Helper function for alarm management.
@@ -201,9 +359,16 @@ private:
     IEventListener *mEventListener; /**< Listener handler to report event. */
     bool mIsStarted; /**< State of the event thread. */
     pthread_t mThreadId; /**< thread id, used for context check. */
-    int mInbandPipe[2]; /**< inband pipe used to trig internal events. */
-    list<SFd> mFdList; /**< List of File descriptors polled by the event thread. */
-    uint32_t mNbPollFds; /**< Number of file descriptor polled. */
+    int mDoorbellFd; /**< eventfd signaling that the mailbox is no longer empty. */
+    Message *mMailbox; /**< Lock-free stack of the posted messages, last posted first. */
+    int mEpollFd; /**< epoll instance of the polled file descriptors, -1 with poll backend. */
+    vector<SFd> mFds; /**< File descriptors registered, by handle. */
+    vector<uint32_t> mFreeHandles; /**< Handles of the free entries of mFds. */
+    map<uint32_t, uint32_t> mHandles; /**< Handles of the client file descriptors, by id. */
+    uint32_t mDoorbellHandle; /**< Handle of the mailbox doorbell. */
+    vector<struct pollfd> mPollFds; /**< Registered fds, -1 if not polled (poll backend). */
+    vector<uint32_t> mPollHandles; /**< Handles of the poll file descriptors (poll backend). */
     int64_t mAlarmMs; /**< Alarm date in milliseconds. */
+    CTimerWheel mTimerWheel; /**< Timers started by the client. */
     bool mLogsOn; /**< Event Thread enabled log flag. */
 };
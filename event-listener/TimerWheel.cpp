@@ -0,0 +1,259 @@
+/* TimerWheel.cpp
+**
+** Copyright 2017 Intel Corporation
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "TimerWheel.h"
+#include "EventListener.h"
+#include <AudioUtilitiesAssert.hpp>
+#include <algorithm>
+#include <limits>
+
+CTimerWheel::CTimerWheel(int64_t nowMs)
+    : mCurrentMs(nowMs),
+      mTimerNb(0)
+{
+    for (int level = 0; level < ELevelNb; level++) {
+        mOccupiedSlots[level] = 0;
+    }
+}
+
+CTimerWheel::~CTimerWheel()
+{
+    for (size_t index = 0; index < mTimers.size(); index++) {
+        delete mTimers[index];
+    }
+}
+
+uint32_t CTimerWheel::start(int64_t nowMs, uint32_t durationMs, uint32_t periodMs, void *context)
+{
+    STimer *timer;
+    if (mFreeIndexes.empty()) {
+        AUDIOUTILITIES_ASSERT(mTimers.size() <= EIndexMask, "Too many timers");
+
+        timer = new STimer;
+        timer->mId = mTimers.size();
+        mTimers.push_back(timer);
+    } else {
+        timer = mTimers[mFreeIndexes.back()];
+        mFreeIndexes.pop_back();
+    }
+    // Change the generation of the timer, ids of its previous uses becoming invalid
+    uint32_t generation = (timer->mId >> EIndexBits) % EGenerationNb + 1;
+    timer->mId = (generation << EIndexBits) | (timer->mId & EIndexMask);
+
+    // The wheel may not have been advanced to now, the deadline being still in its future
+    timer->mDeadlineMs = std::max(nowMs + durationMs, mCurrentMs + 1);
+    timer->mPeriodMs = periodMs;
+    timer->mContext = context;
+    insert(timer);
+    mTimerNb++;
+
+    return timer->mId;
+}
+
+bool CTimerWheel::cancel(uint32_t timerId)
+{
+    STimer *timer = find(timerId);
+
+    if (timer == NULL) {
+        return false;
+    }
+    unlink(timer);
+    release(timer);
+    return true;
+}
+
+int64_t CTimerWheel::getNextWakeupMs() const
+{
+    if (mTimerNb == 0) {
+        return -1;
+    }
+    int64_t wakeupMs = std::numeric_limits<int64_t>::max();
+
+    for (int level = 0; level < ELevelNb; level++) {
+        if (mOccupiedSlots[level] == 0) {
+            continue;
+        }
+        // Slots are reached in circular order, from the one following the current slot
+        int shift = ELevelBits * level;
+        int64_t position = mCurrentMs >> shift;
+        uint32_t first = (position + 1) & ESlotMask;
+        uint64_t slots = mOccupiedSlots[level];
+        if (first != 0) {
+            slots = (slots >> first) | (slots << (ESlotNb - first));
+        }
+        int64_t distance = __builtin_ctzll(slots) + 1;
+
+        // Deadline of the first level slot, cascading date of the upper level slots
+        wakeupMs = std::min(wakeupMs, (position + distance) << shift);
+    }
+    return wakeupMs;
+}
+
+void CTimerWheel::advance(int64_t nowMs, IEventListener *listener)
+{
+    while (mCurrentMs < nowMs) {
+        if (mTimerNb == 0) {
+            mCurrentMs = nowMs;
+            return;
+        }
+        if (mOccupiedSlots[0] == 0) {
+            // Nothing expires before the next cascading, skip the empty slots
+            int64_t lastSlotMs = mCurrentMs | ESlotMask;
+            if (lastSlotMs >= nowMs) {
+                mCurrentMs = nowMs;
+                return;
+            }
+            mCurrentMs = lastSlotMs;
+        }
+        tick(listener);
+    }
+}
+
+void CTimerWheel::tick(IEventListener *listener)
+{
+    mCurrentMs++;
+
+    // When a level wraps, the next slot of the upper level is cascaded
+    uint32_t slot = mCurrentMs & ESlotMask;
+    for (int level = 1; level < ELevelNb && slot == 0; level++) {
+        slot = (mCurrentMs >> (ELevelBits * level)) & ESlotMask;
+        cascade(level, slot);
+    }
+
+    slot = mCurrentMs & ESlotMask;
+    if (!(mOccupiedSlots[0] & (uint64_t(1) << slot))) {
+        return;
+    }
+    splice(&mSlots[0][slot], &mExpiring);
+    mOccupiedSlots[0] &= ~(uint64_t(1) << slot);
+
+    SLink *link;
+    for (link = mExpiring.mNext; link != &mExpiring; link = link->mNext) {
+        static_cast<STimer *>(link)->mLevel = EExpiring;
+    }
+    // The listener may cancel the timers still expiring
+    while (mExpiring.mNext != &mExpiring) {
+        STimer *timer = static_cast<STimer *>(mExpiring.mNext);
+        unlink(timer);
+
+        uint32_t timerId = timer->mId;
+        void *context = timer->mContext;
+
+        // Periodic timers are rearmed before the report, to be cancellable by the listener
+        if (timer->mPeriodMs != 0) {
+            timer->mDeadlineMs += timer->mPeriodMs;
+            if (timer->mDeadlineMs <= mCurrentMs) {
+                // Late, missed expirations are skipped
+                timer->mDeadlineMs = mCurrentMs + timer->mPeriodMs;
+            }
+            insert(timer);
+        } else {
+            release(timer);
+        }
+        listener->onTimer(timerId, context);
+    }
+}
+
+void CTimerWheel::insert(STimer *timer)
+{
+    static const int64_t wheelRangeMs = int64_t(1) << (ELevelBits * ELevelNb);
+
+    int64_t slotMs = timer->mDeadlineMs;
+    int64_t remainingMs = std::max<int64_t>(slotMs - mCurrentMs, 0);
+    if (remainingMs >= wheelRangeMs) {
+        // Wait at the end of the wheel to be cascaded again
+        remainingMs = wheelRangeMs - 1;
+        slotMs = mCurrentMs + remainingMs;
+    }
+    int level = 0;
+    while (remainingMs >= int64_t(1) << (ELevelBits * (level + 1))) {
+        level++;
+    }
+    uint32_t slot = (slotMs >> (ELevelBits * level)) & ESlotMask;
+
+    SLink *head = &mSlots[level][slot];
+    timer->mPrevious = head->mPrevious;
+    timer->mNext = head;
+    head->mPrevious->mNext = timer;
+    head->mPrevious = timer;
+
+    timer->mLevel = level;
+    timer->mSlot = slot;
+    mOccupiedSlots[level] |= uint64_t(1) << slot;
+}
+
+void CTimerWheel::cascade(int level, uint32_t slot)
+{
+    if (!(mOccupiedSlots[level] & (uint64_t(1) << slot))) {
+        return;
+    }
+    SLink cascading;
+    splice(&mSlots[level][slot], &cascading);
+    mOccupiedSlots[level] &= ~(uint64_t(1) << slot);
+
+    while (cascading.mNext != &cascading) {
+        STimer *timer = static_cast<STimer *>(cascading.mNext);
+        cascading.mNext = timer->mNext;
+        insert(timer);
+    }
+}
+
+void CTimerWheel::unlink(STimer *timer)
+{
+    timer->mPrevious->mNext = timer->mNext;
+    timer->mNext->mPrevious = timer->mPrevious;
+    timer->mPrevious = timer->mNext = timer;
+
+    if (timer->mLevel >= 0) {
+        SLink *head = &mSlots[timer->mLevel][timer->mSlot];
+        if (head->mNext == head) {
+            mOccupiedSlots[timer->mLevel] &= ~(uint64_t(1) << timer->mSlot);
+        }
+    }
+}
+
+void CTimerWheel::splice(SLink *from, SLink *to)
+{
+    AUDIOUTILITIES_ASSERT(to->mNext == to, "Splicing to a non empty list");
+
+    if (from->mNext == from) {
+        return;
+    }
+    to->mNext = from->mNext;
+    to->mPrevious = from->mPrevious;
+    to->mNext->mPrevious = to;
+    to->mPrevious->mNext = to;
+    from->mNext = from->mPrevious = from;
+}
+
+void CTimerWheel::release(STimer *timer)
+{
+    timer->mLevel = ENotArmed;
+    mFreeIndexes.push_back(timer->mId & EIndexMask);
+    mTimerNb--;
+}
+
+CTimerWheel::STimer *CTimerWheel::find(uint32_t timerId) const
+{
+    uint32_t index = timerId & EIndexMask;
+
+    if (index >= mTimers.size()) {
+        return NULL;
+    }
+    STimer *timer = mTimers[index];
+    return timer->mId == timerId && timer->mLevel != ENotArmed ? timer : NULL;
+}
@@ -0,0 +1,170 @@
+/* TimerWheel.h
+**
+** Copyright 2017 Intel Corporation
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class IEventListener;
+
+/**
+ * Hierarchical timer wheel, managing many one-shot and periodic timers with O(1) start and cancel.
+ *
+ * The wheel has 4 levels of 64 slots, each slot of a level spanning 64 times the slots of the
+ * previous one: 1ms, 64ms, 4s and 4min. A timer is put in the first level whose range covers its
+ * remaining time, then moved down ("cascaded") level by level as its deadline gets closer, until it
+ * expires from the first level. Timers beyond the wheel range (about 4.6 hours) wait in the last
+ * level and are cascaded again.
+ *
+ * Dates are in milliseconds, from a monotonic clock. The wheel is not thread safe.
+ */
+class CTimerWheel
+{
+private:
+    enum
+    {
+        ELevelBits = 6,
+        ELevelNb = 4,
+        ESlotNb = 1 << ELevelBits,
+        ESlotMask = ESlotNb - 1,
+
+        EIndexBits = 20, /**< Bits of the timer ids holding the timer index, the others holding
+                          *   its generation. */
+        EIndexMask = (1 << EIndexBits) - 1,
+        EGenerationNb = (1 << (32 - EIndexBits)) - 1
+    };
+
+    enum TimerState
+    {
+        ENotArmed = -2, /**< Timer expired or cancelled. */
+        EExpiring = -1 /**< Timer expiring, other values being the level of its slot. */
+    };
+
+    /** Link of the circular doubly linked lists of timers, a slot being a list head. */
+    struct SLink
+    {
+        SLink() : mPrevious(this), mNext(this) {}
+        SLink *mPrevious;
+        SLink *mNext;
+    };
+
+    struct STimer : SLink
+    {
+        uint32_t mId; /**< Generation and index of the timer. */
+        int64_t mDeadlineMs;
+        uint32_t mPeriodMs; /**< 0 for a one-shot timer. */
+        void *mContext;
+        int mLevel; /**< Level of the slot holding the timer, or its TimerState. */
+        uint32_t mSlot;
+    };
+
+public:
+    /**
+     * @param[in] nowMs current date in milliseconds.
+     */
+    explicit CTimerWheel(int64_t nowMs);
+    ~CTimerWheel();
+
+    /**
+     * Start a timer.
+     *
+     * @param[in] nowMs current date in milliseconds.
+     * @param[in] durationMs duration in milliseconds before the timer expires.
+     * @param[in] periodMs period in milliseconds of the following expirations, 0 for a one-shot
+     *                     timer.
+     * @param[in] context pointer given back upon expiration. Note that it may be NULL.
+     *
+     * @return identifier of the timer, never 0.
+     */
+    uint32_t start(int64_t nowMs, uint32_t durationMs, uint32_t periodMs, void *context);
+
+    /**
+     * Cancel a timer.
+     *
+     * @param[in] timerId identifier of the timer.
+     *
+     * @return true if the timer was armed, false if it had already expired or been cancelled.
+     */
+    bool cancel(uint32_t timerId);
+
+    /**
+     * Date until which the wheel has nothing to do: the nearest deadline of the timers, or the
+     * nearest date at which farther timers need to be cascaded.
+     *
+     * @return date in milliseconds, -1 if no timer is armed.
+     */
+    int64_t getNextWakeupMs() const;
+
+    /**
+     * Expire the timers whose deadline is reached, reporting each expiration to the listener
+     * with onTimer. Timers may be started and cancelled from onTimer.
+     *
+     * @param[in] nowMs current date in milliseconds.
+     * @param[in] listener to report expirations to.
+     */
+    void advance(int64_t nowMs, IEventListener *listener);
+
+    /**
+     * @return number of armed timers.
+     */
+    size_t getTimerNb() const { return mTimerNb; }
+
+private:
+    /**
+     * Move the wheel forward by one millisecond and expire the timers of the reached slot.
+     */
+    void tick(IEventListener *listener);
+
+    /**
+     * Put a timer in the slot matching its remaining time.
+     */
+    void insert(STimer *timer);
+
+    /**
+     * Put the timers of an upper level slot back in the slots matching their remaining time.
+     */
+    void cascade(int level, uint32_t slot);
+
+    /**
+     * Remove a timer from its list, keeping track of the occupied slots.
+     */
+    void unlink(STimer *timer);
+
+    /**
+     * Move all the timers of a list to an other one, left empty.
+     */
+    static void splice(SLink *from, SLink *to);
+
+    /**
+     * Disarm a timer, its index being reused by a next timer.
+     */
+    void release(STimer *timer);
+
+    /**
+     * @return the armed timer identified by timerId, NULL if not found.
+     */
+    STimer *find(uint32_t timerId) const;
+
+    SLink mSlots[ELevelNb][ESlotNb]; /**< Lists of the timers of each slot. */
+    uint64_t mOccupiedSlots[ELevelNb]; /**< Bit field of the non empty slots of each level. */
+    SLink mExpiring; /**< Timers of the slot being expired, not reported yet. */
+    int64_t mCurrentMs; /**< Date of the last slot expired. */
+    std::vector<STimer *> mTimers; /**< Timers by index, armed or not. */
+    std::vector<uint32_t> mFreeIndexes; /**< Indexes of the timers not armed. */
+    size_t mTimerNb; /**< Number of armed timers. */
+};
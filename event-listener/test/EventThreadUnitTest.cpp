@@ -0,0 +1,1039 @@
+/* EventThreadUnitTest.cpp
+**
+** Copyright 2017 Intel Corporation
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "EventThread.h"
+#include "EventListener.h"
+#include <Mutex.hpp>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <vector>
+
+using audio_utilities::utilities::Mutex;
+
+/**
+ * Define a test run on both backends, which must report events the same way.
+ *
+ * @param[in] name of the test function, taking the backend as backend parameter.
+ */
+#define EVENT_THREAD_TEST(name)                            \
+    static void name(CEventThread::PollBackend backend);   \
+    TEST(EventThread, name##Poll)                          \
+    {                                                      \
+        name(CEventThread::EPollBackend);                  \
+    }                                                      \
+    TEST(EventThread, name##Epoll)                         \
+    {                                                      \
+        name(CEventThread::EEpollBackend);                 \
+    }                                                      \
+    static void name(CEventThread::PollBackend backend)
+
+/** Longest wait for an event, in milliseconds. */
+static const int EVENT_TIMEOUT_MS = 2000;
+
+/** Wait for events which should not come, in microseconds. */
+static const useconds_t SETTLE_US = 50 * 1000;
+
+/** @return the monotonic date in milliseconds, the clock of the event thread. */
+static int64_t getDateMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * Non blocking pipe, the ends still owned being closed at destruction.
+ */
+class CPipe
+{
+public:
+    CPipe()
+    {
+        int fds[2];
+        EXPECT_EQ(0, pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+        mReadFd = fds[0];
+        mWriteFd = fds[1];
+    }
+
+    ~CPipe()
+    {
+        if (mReadFd >= 0) {
+            close(mReadFd);
+        }
+        if (mWriteFd >= 0) {
+            close(mWriteFd);
+        }
+    }
+
+    int getReadFd() const { return mReadFd; }
+    int getWriteFd() const { return mWriteFd; }
+
+    /** The read end was closed by its owner, the event thread. */
+    void forgetReadFd() { mReadFd = -1; }
+
+    /** Make the read end readable. */
+    void write(const char *bytes = "x") { EXPECT_GT(::write(mWriteFd, bytes, strlen(bytes)), 0); }
+
+private:
+    int mReadFd;
+    int mWriteFd;
+};
+
+/**
+ * Listener recording the events reported by the event thread, tests reacting to them by
+ * overriding react.
+ */
+class CRecordingListener : public IEventListener
+{
+public:
+    enum EventType
+    {
+        EReadable,
+        EWritable,
+        EError,
+        EHangup,
+        EProcess,
+        ETimer,
+        EAlarm
+    };
+
+    struct SEvent
+    {
+        EventType mType;
+        int mFd; /**< -1 for messages, timers and alarms. */
+        void *mContext; /**< Context of the fd, message or timer. */
+        int64_t mDateMs; /**< Monotonic date of the report. */
+    };
+
+    CRecordingListener() : mEventThread(NULL) {}
+    virtual ~CRecordingListener() {}
+
+    void setEventThread(CEventThread *eventThread) { mEventThread = eventThread; }
+
+    size_t getEventNb()
+    {
+        Mutex::Locker locker(mMutex);
+        return mEvents.size();
+    }
+
+    vector<SEvent> getEvents()
+    {
+        Mutex::Locker locker(mMutex);
+        return mEvents;
+    }
+
+    /** @return events of a type on a fd. */
+    size_t count(EventType type, int fd)
+    {
+        Mutex::Locker locker(mMutex);
+        size_t eventNb = 0;
+        for (size_t i = 0; i < mEvents.size(); i++) {
+            if (mEvents[i].mType == type && mEvents[i].mFd == fd) {
+                eventNb++;
+            }
+        }
+        return eventNb;
+    }
+
+    /** @return true if eventNb events were reported before the timeout. */
+    bool waitForEvents(size_t eventNb)
+    {
+        for (int ms = 0; ms < EVENT_TIMEOUT_MS && getEventNb() < eventNb; ms++) {
+            usleep(1000);
+        }
+        return getEventNb() >= eventNb;
+    }
+
+    virtual bool onEvent(int fd) { return onReadable(fd, NULL); }
+
+    virtual bool onReadable(int fd, void *context)
+    {
+        // Consume what is readable, for the next event to be a new one
+        char bytes[256];
+        while (read(fd, bytes, sizeof(bytes)) > 0) {
+        }
+        return record(EReadable, fd, context);
+    }
+
+    virtual bool onWritable(int fd, void *context) { return record(EWritable, fd, context); }
+    virtual bool onError(int fd) { return record(EError, fd, NULL); }
+    virtual bool onHangup(int fd) { return record(EHangup, fd, NULL); }
+    virtual void onAlarm() { record(EAlarm, -1, NULL); }
+    virtual void onTimer(uint32_t /*timerId*/, void *context) { record(ETimer, -1, context); }
+    virtual void onPollError() {}
+    virtual bool onProcess(void *context, uint32_t /*eventId*/)
+    {
+        return record(EProcess, -1, context);
+    }
+
+protected:
+    /**
+     * Called from the event thread for each event, before it is recorded.
+     *
+     * @return the value returned by the callback: true if the fd list has changed.
+     */
+    virtual bool react(const SEvent & /*event*/) { return false; }
+
+    CEventThread *mEventThread;
+
+private:
+    bool record(EventType type, int fd, void *context)
+    {
+        SEvent event = { type, fd, context, getDateMs() };
+        bool fdListChanged = react(event);
+
+        Mutex::Locker locker(mMutex);
+        mEvents.push_back(event);
+        return fdListChanged;
+    }
+
+    Mutex mMutex;
+    vector<SEvent> mEvents;
+};
+
+/**
+ * Listener blocking the event thread in onProcess of a gate message until released, so that
+ * the events of the next wakeup are all ready at once.
+ */
+class CGatedListener : public CRecordingListener
+{
+public:
+    static const size_t gateNb = 2;
+
+    CGatedListener()
+    {
+        for (size_t gate = 0; gate < gateNb; gate++) {
+            mGates[gate].mEntered = false;
+            mGates[gate].mReleased = false;
+        }
+    }
+
+    void *getGate(size_t gate = 0) { return &mGates[gate]; }
+
+    /** Wait for the event thread to be blocked in a gate. */
+    bool waitForEntered(size_t gate = 0)
+    {
+        bool *entered = &mGates[gate].mEntered;
+        for (int ms = 0; ms < EVENT_TIMEOUT_MS && !__atomic_load_n(entered, __ATOMIC_ACQUIRE);
+             ms++) {
+            usleep(1000);
+        }
+        return __atomic_load_n(entered, __ATOMIC_ACQUIRE);
+    }
+
+    void release(size_t gate = 0)
+    {
+        __atomic_store_n(&mGates[gate].mReleased, true, __ATOMIC_RELEASE);
+    }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        for (size_t gate = 0; event.mType == EProcess && gate < gateNb; gate++) {
+            if (event.mContext != getGate(gate)) {
+                continue;
+            }
+            __atomic_store_n(&mGates[gate].mEntered, true, __ATOMIC_RELEASE);
+            while (!__atomic_load_n(&mGates[gate].mReleased, __ATOMIC_ACQUIRE)) {
+                usleep(1000);
+            }
+        }
+        return false;
+    }
+
+private:
+    struct SGate
+    {
+        bool mEntered;
+        bool mReleased;
+    };
+
+    SGate mGates[gateNb];
+};
+
+EVENT_THREAD_TEST(messagesBeforeFdEvents)
+{
+    CGatedListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    CPipe pipe;
+    int context;
+    eventThread.addOpenedFd(1, pipe.getReadFd(), true, &context);
+
+    ASSERT_TRUE(eventThread.start());
+    eventThread.trig(listener.getGate());
+    ASSERT_TRUE(listener.waitForEntered());
+
+    // Both ready for the next wakeup
+    pipe.write();
+    eventThread.trig(&pipe);
+    listener.release();
+
+    ASSERT_TRUE(listener.waitForEvents(3));
+    eventThread.stop();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ(CRecordingListener::EProcess, events[0].mType);
+    EXPECT_EQ(CRecordingListener::EProcess, events[1].mType);
+    EXPECT_EQ(&pipe, events[1].mContext);
+    EXPECT_EQ(CRecordingListener::EReadable, events[2].mType);
+    EXPECT_EQ(pipe.getReadFd(), events[2].mFd);
+    EXPECT_EQ(&context, events[2].mContext);
+}
+
+/** Listener reporting a fd list change on every event. */
+class CChangingListener : public CRecordingListener
+{
+protected:
+    virtual bool react(const SEvent & /*event*/) { return true; }
+};
+
+EVENT_THREAD_TEST(fdListChange)
+{
+    const size_t pipeNb = 3;
+    CChangingListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    CPipe pipes[pipeNb];
+
+    // All ready at the first wakeup
+    for (size_t i = 0; i < pipeNb; i++) {
+        eventThread.addOpenedFd(i, pipes[i].getReadFd(), true);
+        pipes[i].write();
+    }
+    ASSERT_TRUE(eventThread.start());
+
+    // Events not dispatched after the change are reported, once
+    ASSERT_TRUE(listener.waitForEvents(pipeNb));
+    usleep(SETTLE_US);
+    eventThread.stop();
+
+    EXPECT_EQ(pipeNb, listener.getEventNb());
+    for (size_t i = 0; i < pipeNb; i++) {
+        EXPECT_EQ(1u, listener.count(CRecordingListener::EReadable, pipes[i].getReadFd()));
+    }
+}
+
+/** Listener removing the other fds upon the first event. */
+class CRemovingListener : public CRecordingListener
+{
+public:
+    void addFd(uint32_t fdClientId, int fd) { mFdClientIds[fd] = fdClientId; }
+
+    /** @return true if the fd was removed, and closed, by the listener. */
+    bool isRemoved(int fd) { return mFdClientIds.find(fd) == mFdClientIds.end(); }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType != EReadable || getEventNb() != 0) {
+            return false;
+        }
+        map<int, uint32_t>::iterator it = mFdClientIds.begin();
+        while (it != mFdClientIds.end()) {
+            if (it->first == event.mFd) {
+                ++it;
+                continue;
+            }
+            mEventThread->closeAndRemoveFd(it->second);
+            mFdClientIds.erase(it++);
+        }
+        return true;
+    }
+
+private:
+    map<int, uint32_t> mFdClientIds;
+};
+
+EVENT_THREAD_TEST(removeFdWhileDispatching)
+{
+    const size_t pipeNb = 4;
+    CRemovingListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    CPipe pipes[pipeNb];
+
+    for (size_t i = 0; i < pipeNb; i++) {
+        eventThread.addOpenedFd(i, pipes[i].getReadFd(), true);
+        listener.addFd(i, pipes[i].getReadFd());
+        pipes[i].write();
+    }
+    ASSERT_TRUE(eventThread.start());
+
+    // Only the first fd dispatched is reported, the events of the others being dropped
+    ASSERT_TRUE(listener.waitForEvents(1));
+    usleep(SETTLE_US);
+    eventThread.stop();
+
+    ASSERT_EQ(1u, listener.getEventNb());
+    size_t removedNb = 0;
+    for (size_t i = 0; i < pipeNb; i++) {
+        if (listener.isRemoved(pipes[i].getReadFd())) {
+            EXPECT_EQ(-1, eventThread.getFd(i));
+            pipes[i].forgetReadFd();
+            removedNb++;
+        }
+    }
+    EXPECT_EQ(pipeNb - 1, removedNb);
+}
+
+/** Thread posting messages, each one tagged by its rank as event id. */
+class CProducer
+{
+public:
+    /**
+     * @param[in] eventThread receiving the messages.
+     * @param[in] messageNb number of messages to post.
+     * @param[in] waitForEach if true, each message is posted once the previous one is processed.
+     */
+    CProducer(CEventThread &eventThread, uint32_t messageNb, bool waitForEach)
+        : mEventThread(eventThread),
+          mMessageNb(messageNb),
+          mWaitForEach(waitForEach),
+          mProcessedNb(0),
+          mInOrder(true),
+          mTimedOut(false)
+    {}
+
+    bool start() { return pthread_create(&mThread, NULL, run, this) == 0; }
+
+    void join() { pthread_join(mThread, NULL); }
+
+    /** Called from the event thread for each message. */
+    void onProcess(uint32_t eventId)
+    {
+        if (eventId != mProcessedNb) {
+            mInOrder = false;
+        }
+        __atomic_store_n(&mProcessedNb, mProcessedNb + 1, __ATOMIC_RELEASE);
+    }
+
+    /** @return true if all the messages were processed before the timeout. */
+    bool waitForProcessed(uint32_t messageNb)
+    {
+        for (int ms = 0; ms < EVENT_TIMEOUT_MS && getProcessedNb() < messageNb; ms++) {
+            usleep(1000);
+        }
+        return getProcessedNb() >= messageNb;
+    }
+
+    uint32_t getProcessedNb() const { return __atomic_load_n(&mProcessedNb, __ATOMIC_ACQUIRE); }
+    bool isInOrder() const { return mInOrder; }
+    bool hasTimedOut() const { return mTimedOut; }
+
+private:
+    static void *run(void *context)
+    {
+        CProducer *producer = static_cast<CProducer *>(context);
+        for (uint32_t message = 0; message < producer->mMessageNb; message++) {
+            producer->mEventThread.trig(producer, message);
+            if (!producer->mWaitForEach) {
+                continue;
+            }
+            // Spinning, for the next post to race with the doorbell acknowledgment
+            int spinNb = 0;
+            while (producer->getProcessedNb() <= message) {
+                if (++spinNb % 1000 == 0) {
+                    usleep(1000);
+                    if (spinNb >= EVENT_TIMEOUT_MS * 1000) {
+                        producer->mTimedOut = true;
+                        return NULL;
+                    }
+                }
+                sched_yield();
+            }
+        }
+        return NULL;
+    }
+
+    CEventThread &mEventThread;
+    const uint32_t mMessageNb;
+    const bool mWaitForEach;
+    uint32_t mProcessedNb; /**< Written by the event thread only. */
+    bool mInOrder; /**< Written by the event thread only. */
+    bool mTimedOut;
+    pthread_t mThread;
+};
+
+/** Listener giving the messages to their producer. */
+class CProducerListener : public CRecordingListener
+{
+public:
+    virtual bool onProcess(void *context, uint32_t eventId)
+    {
+        static_cast<CProducer *>(context)->onProcess(eventId);
+        return false;
+    }
+};
+
+TEST(EventThread, producerOrder)
+{
+    const size_t producerNb = 8;
+    const uint32_t messageNb = 20000;
+    CProducerListener listener;
+    CEventThread eventThread(&listener, false);
+    ASSERT_TRUE(eventThread.start());
+
+    vector<CProducer *> producers;
+    for (size_t i = 0; i < producerNb; i++) {
+        producers.push_back(new CProducer(eventThread, messageNb, false));
+        ASSERT_TRUE(producers.back()->start());
+    }
+    for (size_t i = 0; i < producerNb; i++) {
+        producers[i]->join();
+    }
+
+    // Processed in the order they were posted, whatever the messages of the other producers
+    for (size_t i = 0; i < producerNb; i++) {
+        EXPECT_TRUE(producers[i]->waitForProcessed(messageNb));
+        EXPECT_EQ(messageNb, producers[i]->getProcessedNb());
+        EXPECT_TRUE(producers[i]->isInOrder());
+    }
+    eventThread.stop();
+    for (size_t i = 0; i < producerNb; i++) {
+        delete producers[i];
+    }
+}
+
+TEST(EventThread, noLostWakeup)
+{
+    // Each message is posted right after the previous one is processed, while the event thread
+    // is between the doorbell acknowledgment and the mailbox exchange, or right after it:
+    // a lost wakeup would leave a message pending until the timeout.
+    const size_t producerNb = 4;
+    const uint32_t messageNb = 5000;
+    CProducerListener listener;
+    CEventThread eventThread(&listener, false);
+    ASSERT_TRUE(eventThread.start());
+
+    vector<CProducer *> producers;
+    for (size_t i = 0; i < producerNb; i++) {
+        producers.push_back(new CProducer(eventThread, messageNb, true));
+        ASSERT_TRUE(producers.back()->start());
+    }
+    for (size_t i = 0; i < producerNb; i++) {
+        producers[i]->join();
+        EXPECT_FALSE(producers[i]->hasTimedOut());
+        EXPECT_EQ(messageNb, producers[i]->getProcessedNb());
+        EXPECT_TRUE(producers[i]->isInOrder());
+    }
+    eventThread.stop();
+    for (size_t i = 0; i < producerNb; i++) {
+        delete producers[i];
+    }
+}
+
+/** Thread stopping an event thread, which returns once the event thread has exited. */
+class CStopper
+{
+public:
+    CStopper(CEventThread &eventThread) : mEventThread(eventThread) {}
+
+    bool start() { return pthread_create(&mThread, NULL, run, this) == 0; }
+
+    void join() { pthread_join(mThread, NULL); }
+
+private:
+    static void *run(void *context)
+    {
+        static_cast<CStopper *>(context)->mEventThread.stop();
+        return NULL;
+    }
+
+    CEventThread &mEventThread;
+    pthread_t mThread;
+};
+
+TEST(EventThread, messagesAfterExit)
+{
+    // The messages left in the mailbox are released with the event thread, leaks being reported
+    // by the address sanitizer of the host test
+    CGatedListener listener;
+    CEventThread eventThread(&listener, false);
+    CStopper stopper(eventThread);
+    int dropped[3];
+
+    ASSERT_TRUE(eventThread.start());
+    eventThread.trig(listener.getGate(0));
+    ASSERT_TRUE(listener.waitForEntered(0));
+
+    // Taken with the exit request, posted by the stopper meanwhile
+    eventThread.trig(listener.getGate(1));
+    ASSERT_TRUE(stopper.start());
+    usleep(SETTLE_US);
+
+    // Posted after the exit request, dropped by the event thread
+    eventThread.trig(&dropped[0]);
+    listener.release(0);
+    ASSERT_TRUE(listener.waitForEntered(1));
+
+    // Posted once the event thread has taken the exit request, left in the mailbox
+    eventThread.trig(&dropped[1]);
+    eventThread.trig(&dropped[2]);
+    listener.release(1);
+    stopper.join();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ(listener.getGate(0), events[0].mContext);
+    EXPECT_EQ(listener.getGate(1), events[1].mContext);
+}
+
+/**
+ * Pipes added and removed in turn, the removed ones leaving holes in the fds of the event
+ * thread, reused by the pipes added next.
+ */
+class CFdChurn
+{
+public:
+    CFdChurn(CEventThread &eventThread) : mEventThread(eventThread) {}
+
+    ~CFdChurn()
+    {
+        for (size_t id = 0; id < mPipes.size(); id++) {
+            delete mPipes[id];
+        }
+    }
+
+    /** Add pipes, identified by their rank, their context being the pipe. */
+    void add(size_t pipeNb)
+    {
+        for (size_t i = 0; i < pipeNb; i++) {
+            CPipe *pipe = new CPipe;
+            mEventThread.addOpenedFd(mPipes.size(), pipe->getReadFd(), true, pipe);
+            mPipes.push_back(pipe);
+        }
+    }
+
+    /** Remove some of the pipes, add as many, and check the fds are still found by id. */
+    void run(size_t roundNb)
+    {
+        for (size_t round = 0; round < roundNb; round++) {
+            size_t removedNb = 0;
+            for (size_t id = round; id < mPipes.size(); id += 3) {
+                if (isRemoved(id)) {
+                    continue;
+                }
+                mEventThread.closeAndRemoveFd(id);
+                mPipes[id]->forgetReadFd();
+                removedNb++;
+            }
+            add(removedNb);
+            check();
+        }
+    }
+
+    void check() const
+    {
+        for (size_t id = 0; id < mPipes.size(); id++) {
+            EXPECT_EQ(mPipes[id]->getReadFd(), mEventThread.getFd(id));
+        }
+    }
+
+    size_t getPipeNb() const { return mPipes.size(); }
+    CPipe &getPipe(size_t id) { return *mPipes[id]; }
+    bool isRemoved(size_t id) const { return mPipes[id]->getReadFd() < 0; }
+
+private:
+    CEventThread &mEventThread;
+    vector<CPipe *> mPipes; /**< Pipes by id, removed ones included. */
+};
+
+/** Listener running a churn of fds upon the churn message. */
+class CChurningListener : public CRecordingListener
+{
+public:
+    CChurningListener() : mChurn(NULL) {}
+
+    void setChurn(CFdChurn *churn) { mChurn = churn; }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType != EProcess || event.mContext != mChurn) {
+            return false;
+        }
+        mChurn->run(4);
+        return true;
+    }
+
+private:
+    CFdChurn *mChurn;
+};
+
+EVENT_THREAD_TEST(addRemoveChurn)
+{
+    CChurningListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    CFdChurn churn(eventThread);
+    listener.setChurn(&churn);
+
+    // Before start, then from the event thread
+    churn.add(32);
+    churn.run(4);
+    ASSERT_TRUE(eventThread.start());
+    eventThread.trig(&churn);
+    ASSERT_TRUE(listener.waitForEvents(1));
+
+    // Each remaining pipe reported once, with its own context
+    size_t remainingNb = 0;
+    for (size_t id = 0; id < churn.getPipeNb(); id++) {
+        if (!churn.isRemoved(id)) {
+            churn.getPipe(id).write();
+            remainingNb++;
+        }
+    }
+    EXPECT_EQ(32u, remainingNb);
+    ASSERT_TRUE(listener.waitForEvents(1 + remainingNb));
+
+    // The doorbell, first of the polled fds, still rings
+    int marker;
+    eventThread.trig(&marker);
+    ASSERT_TRUE(listener.waitForEvents(2 + remainingNb));
+    usleep(SETTLE_US);
+    eventThread.stop();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(2 + remainingNb, events.size());
+    EXPECT_EQ(&marker, events.back().mContext);
+    for (size_t i = 1; i <= remainingNb; i++) {
+        ASSERT_EQ(CRecordingListener::EReadable, events[i].mType);
+        CPipe *pipe = static_cast<CPipe *>(events[i].mContext);
+        EXPECT_EQ(pipe->getReadFd(), events[i].mFd);
+        EXPECT_EQ(1u, listener.count(CRecordingListener::EReadable, pipe->getReadFd()));
+    }
+    churn.check();
+}
+
+/** Listener polling a fd for writable events until the first one, again upon the rearm message. */
+class CWritableListener : public CRecordingListener
+{
+public:
+    static const uint32_t fdClientId = 1;
+
+    void *getRearm() { return &mEventThread; }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType == EWritable) {
+            mEventThread->setFdInterest(fdClientId, 0);
+        } else if (event.mType == EProcess && event.mContext == getRearm()) {
+            mEventThread->setFdInterest(fdClientId, CEventThread::EWritable);
+        }
+        return false;
+    }
+};
+
+EVENT_THREAD_TEST(writable)
+{
+    CWritableListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds));
+    int context;
+    eventThread.addOpenedFd(CWritableListener::fdClientId, fds[0], false, &context);
+    eventThread.setFdInterest(CWritableListener::fdClientId, CEventThread::EWritable);
+
+    ASSERT_TRUE(eventThread.start());
+    ASSERT_TRUE(listener.waitForEvents(1));
+    usleep(SETTLE_US);
+    EXPECT_EQ(1u, listener.getEventNb());
+
+    eventThread.trig(listener.getRearm());
+    ASSERT_TRUE(listener.waitForEvents(3));
+    usleep(SETTLE_US);
+    eventThread.stop();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ(CRecordingListener::EWritable, events[0].mType);
+    EXPECT_EQ(fds[0], events[0].mFd);
+    EXPECT_EQ(&context, events[0].mContext);
+    EXPECT_EQ(CRecordingListener::EProcess, events[1].mType);
+    EXPECT_EQ(CRecordingListener::EWritable, events[2].mType);
+    EXPECT_EQ(&context, events[2].mContext);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/** Listener polling a one-shot fd again upon the rearm message. */
+class COneShotListener : public CRecordingListener
+{
+public:
+    static const uint32_t fdClientId = 1;
+    static const uint32_t interest = CEventThread::EReadable | CEventThread::EOneShot;
+
+    void *getRearm() { return &mEventThread; }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType == EProcess && event.mContext == getRearm()) {
+            mEventThread->setFdInterest(fdClientId, interest);
+        }
+        return false;
+    }
+};
+
+EVENT_THREAD_TEST(oneShotRearm)
+{
+    COneShotListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    CPipe pipe;
+    eventThread.addOpenedFd(COneShotListener::fdClientId, pipe.getReadFd());
+    eventThread.setFdInterest(COneShotListener::fdClientId, COneShotListener::interest);
+    ASSERT_TRUE(eventThread.start());
+
+    pipe.write();
+    ASSERT_TRUE(listener.waitForEvents(1));
+
+    // Disarmed by the first event
+    pipe.write();
+    usleep(SETTLE_US);
+    EXPECT_EQ(1u, listener.getEventNb());
+
+    // Pending data reported once rearmed
+    eventThread.trig(listener.getRearm());
+    ASSERT_TRUE(listener.waitForEvents(3));
+    usleep(SETTLE_US);
+    eventThread.stop();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ(CRecordingListener::EReadable, events[0].mType);
+    EXPECT_EQ(CRecordingListener::EProcess, events[1].mType);
+    EXPECT_EQ(CRecordingListener::EReadable, events[2].mType);
+    EXPECT_EQ(pipe.getReadFd(), events[2].mFd);
+}
+
+/** Listener changing the interest of the other fds upon the first readable event. */
+class CInterestChangingListener : public CRecordingListener
+{
+public:
+    enum
+    {
+        EFirstId,
+        EStoppedId,
+        EWritableId
+    };
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType == EReadable && event.mContext == NULL) {
+            mEventThread->setFdInterest(EStoppedId, 0);
+            mEventThread->setFdInterest(EWritableId, CEventThread::EWritable);
+        } else if (event.mType == EWritable) {
+            mEventThread->setFdInterest(EWritableId, 0);
+        }
+        return false;
+    }
+};
+
+EVENT_THREAD_TEST(staleEventsAfterInterestChange)
+{
+    CInterestChangingListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    CPipe first;
+    CPipe stopped;
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds));
+    int stoppedContext;
+    int writableContext;
+
+    // All readable at the first wakeup, the first fd being dispatched first
+    eventThread.addOpenedFd(CInterestChangingListener::EFirstId, first.getReadFd(), true);
+    eventThread.addOpenedFd(CInterestChangingListener::EStoppedId, stopped.getReadFd(), true,
+                            &stoppedContext);
+    eventThread.addOpenedFd(CInterestChangingListener::EWritableId, fds[0], true,
+                            &writableContext);
+    first.write();
+    stopped.write();
+    EXPECT_EQ(1, write(fds[1], "x", 1));
+    ASSERT_TRUE(eventThread.start());
+
+    // Readable events of the wakeup are not reported once no longer polled
+    ASSERT_TRUE(listener.waitForEvents(2));
+    usleep(SETTLE_US);
+    eventThread.stop();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ(CRecordingListener::EReadable, events[0].mType);
+    EXPECT_EQ(first.getReadFd(), events[0].mFd);
+    EXPECT_EQ(CRecordingListener::EWritable, events[1].mType);
+    EXPECT_EQ(&writableContext, events[1].mContext);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/**
+ * Listener removing a fd upon the first readable event, and adding an other one in its place.
+ */
+class CReplacingListener : public CRecordingListener
+{
+public:
+    enum
+    {
+        EFirstId,
+        EOneShotId,
+        ERemovedId,
+        EAddedId
+    };
+
+    CReplacingListener() : mAdded(NULL) {}
+
+    void setAdded(CPipe *added) { mAdded = added; }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType != EReadable || event.mContext != NULL) {
+            return false;
+        }
+        mEventThread->closeAndRemoveFd(ERemovedId);
+        mEventThread->addOpenedFd(EAddedId, mAdded->getReadFd(), true, mAdded);
+        return true;
+    }
+
+private:
+    CPipe *mAdded;
+};
+
+EVENT_THREAD_TEST(dispatchAfterFdListChange)
+{
+    CReplacingListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    CPipe first;
+    CPipe oneShot;
+    CPipe removed;
+    CPipe added;
+    listener.setAdded(&added);
+
+    // All but the added one readable at the first wakeup, the first fd being dispatched first
+    eventThread.addOpenedFd(CReplacingListener::EFirstId, first.getReadFd(), true);
+    eventThread.addOpenedFd(CReplacingListener::EOneShotId, oneShot.getReadFd(), false, &oneShot);
+    eventThread.setFdInterest(CReplacingListener::EOneShotId,
+                              CEventThread::EReadable | CEventThread::EOneShot);
+    eventThread.addOpenedFd(CReplacingListener::ERemovedId, removed.getReadFd(), true, &removed);
+    first.write();
+    oneShot.write();
+    removed.write();
+    ASSERT_TRUE(eventThread.start());
+
+    // The one-shot event, not reported again, is dispatched despite the fd list change. The event
+    // of the removed fd is not given to the fd added in its place.
+    ASSERT_TRUE(listener.waitForEvents(2));
+    usleep(SETTLE_US);
+    eventThread.stop();
+    removed.forgetReadFd();
+
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ(CRecordingListener::EReadable, events[0].mType);
+    EXPECT_EQ(first.getReadFd(), events[0].mFd);
+    EXPECT_EQ(CRecordingListener::EReadable, events[1].mType);
+    EXPECT_EQ(&oneShot, events[1].mContext);
+}
+
+/** Listener cancelling the periodic timer from onTimer, and the alarm from onAlarm. */
+class CTimerCancellingListener : public CRecordingListener
+{
+public:
+    CTimerCancellingListener() : mPeriodicId(0), mPeriodicNb(0), mCancelled(false) {}
+
+    /** Cancel the periodic timer once it has expired expirationNb times. */
+    void setPeriodic(uint32_t timerId, size_t expirationNb)
+    {
+        mPeriodicId = timerId;
+        mPeriodicNb = expirationNb;
+    }
+
+    void *getPeriodicContext() { return &mPeriodicId; }
+    bool isCancelled() const { return mCancelled; }
+
+protected:
+    virtual bool react(const SEvent &event)
+    {
+        if (event.mType == EAlarm) {
+            mEventThread->cancelAlarm();
+        } else if (event.mType == ETimer && event.mContext == getPeriodicContext() &&
+                   --mPeriodicNb == 0) {
+            mCancelled = mEventThread->cancelTimer(mPeriodicId);
+        }
+        return false;
+    }
+
+private:
+    uint32_t mPeriodicId;
+    size_t mPeriodicNb;
+    bool mCancelled;
+};
+
+EVENT_THREAD_TEST(timersAndAlarm)
+{
+    // Reported late by at most this delay: woken up by the nearest of the timers and alarm
+    const int64_t latenessMs = 30;
+    CTimerCancellingListener listener;
+    CEventThread eventThread(&listener, false, backend);
+    listener.setEventThread(&eventThread);
+    int oneShotContext;
+
+    const int64_t startMs = getDateMs();
+    uint32_t oneShotId = eventThread.startTimer(150, 0, &oneShotContext);
+    uint32_t periodicId = eventThread.startTimer(40, 40, listener.getPeriodicContext());
+    EXPECT_NE(oneShotId, periodicId);
+    listener.setPeriodic(periodicId, 3);
+    eventThread.startAlarm(100);
+    ASSERT_TRUE(eventThread.start());
+
+    ASSERT_TRUE(listener.waitForEvents(5));
+    usleep(4 * SETTLE_US);
+    eventThread.stop();
+
+    // The periodic timer, cancelled at its third expiration, and the alarm are reported once
+    EXPECT_TRUE(listener.isCancelled());
+    vector<CRecordingListener::SEvent> events = listener.getEvents();
+    ASSERT_EQ(5u, events.size());
+    const CRecordingListener::EventType types[] = {
+        CRecordingListener::ETimer, CRecordingListener::ETimer, CRecordingListener::EAlarm,
+        CRecordingListener::ETimer, CRecordingListener::ETimer
+    };
+    void *const contexts[] = {
+        listener.getPeriodicContext(), listener.getPeriodicContext(), NULL,
+        listener.getPeriodicContext(), &oneShotContext
+    };
+    const int64_t dueMs[] = { 40, 80, 100, 120, 150 };
+    for (size_t i = 0; i < events.size(); i++) {
+        EXPECT_EQ(types[i], events[i].mType) << "event " << i;
+        EXPECT_EQ(contexts[i], events[i].mContext) << "event " << i;
+        EXPECT_GE(events[i].mDateMs - startMs, dueMs[i]) << "event " << i;
+        EXPECT_LT(events[i].mDateMs - startMs, dueMs[i] + latenessMs) << "event " << i;
+    }
+}
@@ -0,0 +1,250 @@
+/* TimerWheelUnitTest.cpp
+**
+** Copyright 2017 Intel Corporation
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "TimerWheel.h"
+#include "EventListener.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+/** Arbitrary date, not aligned on the wheel slots. */
+static const int64_t START_MS = 1000000007;
+
+/**
+ * Listener recording the expirations, with the date the wheel was advanced to.
+ */
+class CTimerListener : public IEventListener
+{
+public:
+    struct SExpiration
+    {
+        uint32_t mTimerId;
+        void *mContext;
+        int64_t mDateMs;
+    };
+
+    CTimerListener(CTimerWheel &wheel)
+        : mWheel(wheel), mNowMs(START_MS), mCancelledId(0), mCancelAfterNb(0), mCancelled(false)
+    {}
+
+    /** Advance the wheel to a date. */
+    void advance(int64_t nowMs)
+    {
+        mNowMs = nowMs;
+        mWheel.advance(nowMs, this);
+    }
+
+    /**
+     * Advance the wheel from wakeup to wakeup, as the event thread does, until no timer is armed.
+     *
+     * @return number of wakeups.
+     */
+    size_t advanceToLastTimer()
+    {
+        size_t wakeupNb = 0;
+        int64_t wakeupMs;
+        while ((wakeupMs = mWheel.getNextWakeupMs()) >= 0) {
+            EXPECT_GT(wakeupMs, mNowMs);
+            advance(wakeupMs);
+            wakeupNb++;
+        }
+        return wakeupNb;
+    }
+
+    /** Cancel a timer from onTimer, once it has expired expirationNb times. */
+    void cancelFromTimer(uint32_t timerId, size_t expirationNb)
+    {
+        mCancelledId = timerId;
+        mCancelAfterNb = expirationNb;
+    }
+
+    bool isCancelled() const { return mCancelled; }
+
+    size_t count(uint32_t timerId) const
+    {
+        size_t expirationNb = 0;
+        for (size_t i = 0; i < mExpirations.size(); i++) {
+            if (mExpirations[i].mTimerId == timerId) {
+                expirationNb++;
+            }
+        }
+        return expirationNb;
+    }
+
+    const std::vector<SExpiration> &getExpirations() const { return mExpirations; }
+
+    virtual void onTimer(uint32_t timerId, void *context)
+    {
+        SExpiration expiration = { timerId, context, mNowMs };
+        mExpirations.push_back(expiration);
+
+        if (timerId == mCancelledId && count(timerId) == mCancelAfterNb) {
+            mCancelled = mWheel.cancel(timerId);
+        }
+    }
+
+    virtual bool onEvent(int /*fd*/) { return false; }
+    virtual bool onError(int /*fd*/) { return false; }
+    virtual bool onHangup(int /*fd*/) { return false; }
+    virtual void onAlarm() {}
+    virtual void onPollError() {}
+    virtual bool onProcess(void * /*context*/, uint32_t /*eventId*/) { return false; }
+
+private:
+    CTimerWheel &mWheel;
+    int64_t mNowMs;
+    uint32_t mCancelledId;
+    size_t mCancelAfterNb;
+    bool mCancelled;
+    std::vector<SExpiration> mExpirations;
+};
+
+TEST(TimerWheel, cascading)
+{
+    // On each side of the level boundaries, and beyond the wheel range of 2^24ms
+    const uint32_t durationsMs[] = {
+        1, 63, 64, 65, 4095, 4096, 262143, 262144, 16777215, 16777216, 40000000, 100000000
+    };
+    const size_t timerNb = sizeof(durationsMs) / sizeof(durationsMs[0]);
+    CTimerWheel wheel(START_MS);
+    CTimerListener listener(wheel);
+
+    uint32_t timerIds[timerNb];
+    for (size_t i = 0; i < timerNb; i++) {
+        timerIds[i] = wheel.start(START_MS, durationsMs[i], 0, &timerIds[i]);
+        EXPECT_NE(0u, timerIds[i]);
+    }
+    EXPECT_EQ(timerNb, wheel.getTimerNb());
+
+    // Woken up to expire or cascade the timers only
+    size_t wakeupNb = listener.advanceToLastTimer();
+    EXPECT_LT(wakeupNb, 1000u);
+    EXPECT_EQ(0u, wheel.getTimerNb());
+
+    // Expired once each, at their deadline, in the order of their deadlines
+    const std::vector<CTimerListener::SExpiration> &expirations = listener.getExpirations();
+    ASSERT_EQ(timerNb, expirations.size());
+    for (size_t i = 0; i < timerNb; i++) {
+        EXPECT_EQ(timerIds[i], expirations[i].mTimerId);
+        EXPECT_EQ(&timerIds[i], expirations[i].mContext);
+        EXPECT_EQ(START_MS + durationsMs[i], expirations[i].mDateMs);
+        EXPECT_FALSE(wheel.cancel(timerIds[i]));
+    }
+}
+
+TEST(TimerWheel, periodicCancelledFromTimer)
+{
+    CTimerWheel wheel(START_MS);
+    CTimerListener listener(wheel);
+    uint32_t periodicId = wheel.start(START_MS, 5, 10, NULL);
+    uint32_t oneShotId = wheel.start(START_MS, 100, 0, NULL);
+    listener.cancelFromTimer(periodicId, 3);
+
+    listener.advance(START_MS + 1000);
+
+    // Rearmed before its expiration is reported, then cancelled
+    EXPECT_TRUE(listener.isCancelled());
+    EXPECT_EQ(3u, listener.count(periodicId));
+    EXPECT_EQ(1u, listener.count(oneShotId));
+    const std::vector<CTimerListener::SExpiration> &expirations = listener.getExpirations();
+    ASSERT_EQ(4u, expirations.size());
+    EXPECT_FALSE(wheel.cancel(periodicId));
+    EXPECT_EQ(0u, wheel.getTimerNb());
+    EXPECT_EQ(-1, wheel.getNextWakeupMs());
+}
+
+TEST(TimerWheel, periodic)
+{
+    CTimerWheel wheel(START_MS);
+    CTimerListener listener(wheel);
+    uint32_t timerId = wheel.start(START_MS, 10, 10, NULL);
+
+    // Advanced over several periods at once, each expiration is reported
+    listener.advance(START_MS + 95);
+    EXPECT_EQ(9u, listener.count(timerId));
+    EXPECT_EQ(START_MS + 100, wheel.getNextWakeupMs());
+    EXPECT_TRUE(wheel.cancel(timerId));
+}
+
+TEST(TimerWheel, staleId)
+{
+    CTimerWheel wheel(START_MS);
+    CTimerListener listener(wheel);
+
+    uint32_t cancelledId = wheel.start(START_MS, 10, 0, NULL);
+    EXPECT_TRUE(wheel.cancel(cancelledId));
+    EXPECT_FALSE(wheel.cancel(cancelledId));
+
+    // Reusing the released timer, under an other id
+    uint32_t expiredId = wheel.start(START_MS, 10, 0, NULL);
+    EXPECT_NE(cancelledId, expiredId);
+    EXPECT_FALSE(wheel.cancel(cancelledId));
+    EXPECT_EQ(1u, wheel.getTimerNb());
+    listener.advance(START_MS + 10);
+    EXPECT_EQ(1u, listener.count(expiredId));
+
+    uint32_t armedId = wheel.start(START_MS + 10, 10, 0, NULL);
+    EXPECT_NE(cancelledId, armedId);
+    EXPECT_NE(expiredId, armedId);
+    EXPECT_FALSE(wheel.cancel(cancelledId));
+    EXPECT_FALSE(wheel.cancel(expiredId));
+    EXPECT_EQ(1u, wheel.getTimerNb());
+
+    listener.advance(START_MS + 20);
+    EXPECT_EQ(1u, listener.count(armedId));
+    EXPECT_EQ(0u, listener.count(cancelledId));
+}
+
+TEST(TimerWheel, nextWakeup)
+{
+    CTimerWheel wheel(START_MS);
+    CTimerListener listener(wheel);
+    EXPECT_EQ(-1, wheel.getNextWakeupMs());
+
+    // Nearest deadline in the first level
+    uint32_t nearId = wheel.start(START_MS, 10, 0, NULL);
+    EXPECT_EQ(START_MS + 10, wheel.getNextWakeupMs());
+    uint32_t nearerId = wheel.start(START_MS, 3, 0, NULL);
+    EXPECT_EQ(START_MS + 3, wheel.getNextWakeupMs());
+    EXPECT_TRUE(wheel.cancel(nearerId));
+    EXPECT_EQ(START_MS + 10, wheel.getNextWakeupMs());
+
+    // Not reached, nothing expires
+    listener.advance(START_MS + 9);
+    EXPECT_EQ(0u, listener.getExpirations().size());
+    EXPECT_EQ(START_MS + 10, wheel.getNextWakeupMs());
+    listener.advance(START_MS + 10);
+    EXPECT_EQ(1u, listener.count(nearId));
+    EXPECT_EQ(-1, wheel.getNextWakeupMs());
+
+    // Farther deadlines: cascading dates first, never after the deadline
+    const int64_t nowMs = START_MS + 10;
+    const int64_t deadlineMs = nowMs + 300000;
+    uint32_t farId = wheel.start(nowMs, 300000, 0, NULL);
+    int64_t wakeupMs = wheel.getNextWakeupMs();
+    EXPECT_GT(wakeupMs, nowMs);
+    EXPECT_LT(wakeupMs, deadlineMs);
+    while (wakeupMs < deadlineMs) {
+        listener.advance(wakeupMs);
+        EXPECT_EQ(0u, listener.count(farId));
+        int64_t nextWakeupMs = wheel.getNextWakeupMs();
+        EXPECT_GT(nextWakeupMs, wakeupMs);
+        wakeupMs = nextWakeupMs;
+    }
+    EXPECT_EQ(deadlineMs, wakeupMs);
+    listener.advance(wakeupMs);
+    EXPECT_EQ(1u, listener.count(farId));
+}
@@ -17,12 +17,18 @@
 
 #include "result/ErrnoResult.hpp"
 #include "AudioNonCopyable.hpp"
+#include <sys/inotify.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <time.h>
 
+#include <algorithm>
+#include <limits>
 #include <string>
 
 
@@ -32,6 +38,17 @@ namespace utilities
 {
 
 /** Map a File in memory.
+ *
+ *  The file is either mapped whole, or through a window sliding along it,
+ *  or followed while an other process writes it, or created to be written
+ *  through a shared mapping.
+ *  A window bounds the virtual memory used, thus files of any size can be
+ *  walked, even on 32 bits targets:
+ *
+ *      for (Result res = mapper.mapWindow(size, overlap); res.isSuccess();
+ *           res = mapper.nextWindow()) {
+ *          process(mapper.getMappedFile(), mapper.getMappedFileSize());
+ *      }
  *
  *  tparam T the type of the resulting data array
  */
@@ -46,7 +63,25 @@ public:
         Success = 444,
         Unknown,
         NoSuchFile,
-        MemoryError
+        MemoryError,
+        EndOfFile,
+        AdviceError
+    };
+
+    /** Mapping options, to be combined. They apply to every window in window mode. */
+    enum Option
+    {
+        NoOption = 0,
+        /** Read the whole mapping at map time (MAP_POPULATE), no page fault happens later. */
+        Populate = 1 << 0,
+        /** Values will be read in order, pages are read ahead aggressively
+         *  and dropped soon after access (MADV_SEQUENTIAL). */
+        Sequential = 1 << 1,
+        /** Start reading the whole mapping asynchronously (MADV_WILLNEED). */
+        WillNeed = 1 << 2,
+        /** Back the mapping with huge pages (MADV_HUGEPAGE), only supported
+         *  for files by kernels built with CONFIG_READ_ONLY_THP_FOR_FS. */
+        HugePages = 1 << 3
     };
 
     struct FileMapperStatus
@@ -68,6 +103,10 @@ public:
                 return "No such file";
             case MemoryError:
                 return "Memory error";
+            case EndOfFile:
+                return "End of file";
+            case AdviceError:
+                return "Advice error";
             }
             /* Unreachable, prevents gcc to complain */
             return "Invalid error (Unreachable)";
@@ -80,24 +119,138 @@ public:
     /** Mapper Constructor.
      *
      *  @param[in] fileName the name of the file to map.
+     *  @param[in] options combination of Option applied to the mappings.
      */
-    FileMapper(const char *fileName);
+    FileMapper(const char *fileName, int options = NoOption);
 
     /** The mapper keep the owning of the resulting data array.  */
     ~FileMapper();
 
     /** Launch the mapping
      *
-     *  @return the Result object containing information about mapping
+     *  @return the Result object containing information about mapping,
+     *          AdviceError if an advice option was refused, the file being
+     *          mapped nonetheless.
      */
     Result map();
 
-    /** Mapped File size getter */
+    /** Map the first window of the file.
+     *
+     *  Windows are mapped from the page holding their first value, thus
+     *  at most windowValueNb values plus a page are mapped at a time.
+     *
+     *  @param[in] windowValueNb number of values of the windows, the last
+     *                           window may be shorter.
+     *  @param[in] overlapValueNb number of values shared by two consecutive
+     *                            windows, less than windowValueNb.
+     *  @param[in] position index in the file of the first value of the window.
+     *  @return EndOfFile if the file has no value from position,
+     *          AdviceError as map().
+     */
+    Result mapWindow(size_t windowValueNb, size_t overlapValueNb = 0, uint64_t position = 0);
+
+    /** Slide the window forward by windowValueNb - overlapValueNb values.
+     *
+     *  @return EndOfFile if the current window was the last one, the current
+     *          window staying mapped.
+     */
+    Result nextWindow();
+
+    /** Map a file still being written, to process its values as they come.
+     *
+     *  The values already written are mapped, then waitForValues extends
+     *  the mapping as the file grows. For example to correlate a capture
+     *  while it is recorded:
+     *
+     *      size_t newValueNb;
+     *      while (mapper.waitForValues(timeoutMs, newValueNb).isSuccess() && newValueNb > 0) {
+     *          correlator.pushA(mapper.getMappedFile() + mapper.getMappedFileSize() - newValueNb,
+     *                           newValueNb);
+     *      }
+     *
+     *  Values processed can be dropped from memory with release.
+     */
+    Result follow();
+
+    /** Wait for the followed file to grow and extend the mapping to its new values.
+     *
+     *  Growth is notified by inotify, or polled if inotify is not available.
+     *  Only complete values are mapped. The mapping may move, pointers to the
+     *  previous one are invalidated.
+     *
+     *  @param[in] timeoutMs maximum time to wait for new values, in milliseconds:
+     *                       0 to only check, negative to wait forever.
+     *  @param[out] newValueNb number of values appended to the mapping, 0 if
+     *                         the file did not grow before the timeout.
+     */
+    Result waitForValues(int timeoutMs, size_t &newValueNb);
+
+    /** Create or truncate the file to a size and map it writable.
+     *
+     *  The mapping is shared: values written in it reach the file, without
+     *  any copy. The file is filled with zeros.
+     *
+     *  @param[in] valueNb size of the file, in values, not null.
+     *  @return NoSuchFile if the file can not be created, AdviceError as map().
+     */
+    Result create(size_t valueNb);
+
+    /** Resize a created file and its mapping, to grow it chunk by chunk.
+     *
+     *  The mapping may move, pointers to the previous one are invalidated.
+     *  Values beyond the file end are lost: once written, a file grown by
+     *  chunks should be resized to the number of values actually written.
+     *
+     *  @param[in] valueNb new size of the file, in values, not null.
+     */
+    Result resize(size_t valueNb);
+
+    enum SyncMode
+    {
+        /** Wait for the values to be written to the storage (MS_SYNC). */
+        Synchronous,
+        /** Only schedule the write (MS_ASYNC). */
+        Asynchronous
+    };
+
+    /** Flush the values written in a created file to the storage. */
+    Result sync(SyncMode mode = Synchronous);
+
+    /** Start reading a range of the mapping asynchronously (MADV_WILLNEED).
+     *
+     *  @param[in] position index in the file of the first value of the range.
+     *  @param[in] valueNb number of values of the range.
+     *  @return MemoryError if the range is not mapped.
+     */
+    Result prefetch(uint64_t position, size_t valueNb);
+
+    /** Drop the pages of a range already processed (MADV_DONTNEED).
+     *
+     *  Only the pages entirely within the range are dropped, reading them
+     *  again faults them back from the file.
+     *
+     *  @see prefetch for the parameters.
+     */
+    Result release(uint64_t position, size_t valueNb);
+
+    /** Mapped File size getter, the size of the current window in window mode. */
     size_t getMappedFileSize() const;
 
-    /** Mapped file getter */
+    /** Mapped file getter, the current window in window mode. */
     const T *getMappedFile() const;
 
+    /** @return the values of a created file, NULL if the file was not created. */
+    T *getWritableFile();
+
+    /** @return the index in the file of the first mapped value. */
+    uint64_t getMappedFilePosition() const { return mPosition; }
+
+    /** @return the number of values of the whole file, once mapped. */
+    uint64_t getFileValueNb() const { return mFileSize / sizeof(T); }
+
+    /** @return the descriptor of the mapped file, -1 if it is not opened. */
+    int getFileDescriptor() const { return mFileState != Closed ? mFileDescriptor : -1; }
+
 private:
     enum FileState
     {
@@ -106,43 +259,104 @@ private:
         Mapped,
     };
 
+    /** Open the file and get its size.
+     *
+     *  @param[in] flags added to O_LARGEFILE to open the file.
+     */
+    Result open(int flags);
+
+    /** Map valueNb values from a position of the file. */
+    Result mapRange(uint64_t position, size_t valueNb);
+
+    void unmap();
+
+    /** Map the complete values of the followed file not mapped yet.
+     *
+     *  @param[out] newValueNb number of values appended to the mapping.
+     */
+    Result extendMapping(size_t &newValueNb);
+
+    /** @return the monotonic time, in milliseconds. */
+    static int64_t getTimeMs();
+
+    /** Apply the advice options to the current mapping. */
+    Result adviseMapping();
+
+    /** madvise the pages of a range of the mapping.
+     *
+     *  @param[in] outward true to extend the range to whole pages, false to shrink it.
+     */
+    Result advise(uint64_t position, size_t valueNb, int advice, bool outward);
+
+    static uint64_t getPageSize() { return sysconf(_SC_PAGESIZE); }
+
     const char *const mFileName;
+    const int mOptions;
+
+    /** True once the file is created, its mapping being shared and writable */
+    bool mWritable;
 
     /** The resulting data array */
     T *mMappedFile;
+    size_t mMappedValueNb;
+
+    /** The mapping itself, starting at a page boundary */
+    void *mMapping;
+    size_t mMappingSize;
 
     /** Current state of the file, usefull to clean memory */
     FileState mFileState;
 
     int mFileDescriptor;
-    size_t mFileSize;
+    uint64_t mFileSize;
+
+    /** Window mode, the windows being mapped if mWindowValueNb is not null */
+    size_t mWindowValueNb;
+    size_t mWindowHopNb;
+    uint64_t mPosition;
+
+    /** Follow mode, file growth being notified by mInotifyDescriptor if valid */
+    bool mFollowing;
+    int mInotifyDescriptor;
 };
 
 template <class T>
-FileMapper<T>::FileMapper(const char *fileName)
-    : mFileName(fileName), mMappedFile(NULL), mFileState(Closed),
-      mFileDescriptor(-1), mFileSize(0)
+FileMapper<T>::FileMapper(const char *fileName, int options)
+    : mFileName(fileName), mOptions(options), mWritable(false), mMappedFile(NULL),
+      mMappedValueNb(0), mMapping(NULL), mMappingSize(0), mFileState(Closed),
+      mFileDescriptor(-1), mFileSize(0), mWindowValueNb(0), mWindowHopNb(0), mPosition(0),
+      mFollowing(false), mInotifyDescriptor(-1)
 {}
 
 template <class T>
 FileMapper<T>::~FileMapper()
 {
-
-    if (mFileState == Mapped) {
-        munmap(mMappedFile, mFileSize);
-        mFileState = Opened;
-    }
+    unmap();
 
     if (mFileState == Opened) {
         close(mFileDescriptor);
     }
+    if (mInotifyDescriptor >= 0) {
+        close(mInotifyDescriptor);
+    }
+}
+
+template <class T>
+void FileMapper<T>::unmap()
+{
+    if (mFileState == Mapped) {
+        munmap(mMapping, mMappingSize);
+        mMappedFile = NULL;
+        mMappedValueNb = 0;
+        mFileState = Opened;
+    }
 }
 
 template <class T>
 size_t FileMapper<T>::getMappedFileSize() const
 {
-    // FileSize is initialized to 0, no need to check the file state
-    return mFileSize / sizeof(T);
+    // Initialized to 0, no need to check the file state
+    return mMappedValueNb;
 }
 
 template <class T>
@@ -156,39 +370,373 @@ const T *FileMapper<T>::getMappedFile() const
 }
 
 template <class T>
-typename FileMapper<T>::Result FileMapper<T>::map()
+T *FileMapper<T>::getWritableFile()
+{
+    if (mFileState == Mapped && mWritable) {
+        return mMappedFile;
+    }
+
+    return NULL;
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::open(int flags)
 {
     using utilities::result::ErrnoResult;
 
-    // Open the file
-    mFileDescriptor = open(mFileName, O_RDONLY);
+    if (mFileState != Closed) {
+        return Result::success();
+    }
+
+    // Open the file, large files being only mapped by windows on 32 bits targets
+    mFileDescriptor = ::open(mFileName, flags | O_LARGEFILE, 0666);
     if (mFileDescriptor < 0) {
         return Result(NoSuchFile) << mFileName << ErrnoResult(errno);
     }
     mFileState = Opened;
 
     // Get File size
-    struct stat fileStat;
-    if ((fstat(mFileDescriptor, &fileStat) == -1)) {
+    struct stat64 fileStat;
+    if ((fstat64(mFileDescriptor, &fileStat) == -1)) {
         return Result(Unknown) << "fstat fails on" << mFileName << ErrnoResult(errno);
     }
     mFileSize = fileStat.st_size;
 
+    return Result::success();
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::mapRange(uint64_t position, size_t valueNb)
+{
+    using utilities::result::ErrnoResult;
+
+    const uint64_t pageSize = getPageSize();
+    uint64_t offset = position * sizeof(T);
+    uint64_t pageOffset = offset - offset % pageSize;
+    size_t mappingSize = size_t(offset - pageOffset) + valueNb * sizeof(T);
+
+    int flags = mWritable ? MAP_SHARED : MAP_PRIVATE;
+    int protection = mWritable ? PROT_READ | PROT_WRITE : PROT_READ;
+#ifdef MAP_POPULATE
+    if (mOptions & Populate) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+
     // Map the file in Memory
-    mMappedFile = static_cast<T *>(mmap(
-                                       NULL,
-                                       mFileSize,
-                                       PROT_READ,
-                                       MAP_PRIVATE,
-                                       mFileDescriptor,
-                                       0));
-    if (mMappedFile == MAP_FAILED) {
+    void *mapping = mmap64(NULL, mappingSize, protection, flags, mFileDescriptor,
+                           pageOffset);
+    if (mapping == MAP_FAILED) {
         return Result(MemoryError) << "while mapping " << mFileName << ErrnoResult(errno);
     }
+    unmap();
+
+    mMapping = mapping;
+    mMappingSize = mappingSize;
+    mMappedFile = reinterpret_cast<T *>(static_cast<char *>(mapping) + (offset - pageOffset));
+    mMappedValueNb = valueNb;
+    mPosition = position;
     mFileState = Mapped;
 
+    return adviseMapping();
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::adviseMapping()
+{
+    using utilities::result::ErrnoResult;
+
+    if ((mOptions & Sequential) && madvise(mMapping, mMappingSize, MADV_SEQUENTIAL) != 0) {
+        return Result(AdviceError) << "MADV_SEQUENTIAL on " << mFileName << ErrnoResult(errno);
+    }
+    if ((mOptions & WillNeed) && madvise(mMapping, mMappingSize, MADV_WILLNEED) != 0) {
+        return Result(AdviceError) << "MADV_WILLNEED on " << mFileName << ErrnoResult(errno);
+    }
+    if (mOptions & HugePages) {
+#ifdef MADV_HUGEPAGE
+        if (madvise(mMapping, mMappingSize, MADV_HUGEPAGE) != 0) {
+            return Result(AdviceError) << "MADV_HUGEPAGE on " << mFileName << ErrnoResult(errno);
+        }
+#else
+        return Result(AdviceError) << "huge pages are not supported";
+#endif
+    }
     return Result::success();
 }
 
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::advise(uint64_t position, size_t valueNb,
+                                                     int advice, bool outward)
+{
+    using utilities::result::ErrnoResult;
+
+    if (mFileState != Mapped || position < mPosition ||
+        position - mPosition > mMappedValueNb ||
+        valueNb > mMappedValueNb - (position - mPosition)) {
+        return Result(MemoryError) << "values [" << position << ", " << position + valueNb
+                                   << "[ are not mapped";
+    }
+    // Offsets from the start of the mapping, which is page aligned
+    const uint64_t pageSize = getPageSize();
+    char *first = reinterpret_cast<char *>(mMappedFile + (position - mPosition));
+    uint64_t begin = first - static_cast<char *>(mMapping);
+    uint64_t end = begin + valueNb * sizeof(T);
+    if (outward) {
+        begin -= begin % pageSize;
+        end = std::min<uint64_t>(end + pageSize - 1 - (end + pageSize - 1) % pageSize,
+                                 mMappingSize);
+    } else {
+        begin += (pageSize - begin % pageSize) % pageSize;
+        // The end of the mapping releases its last partial page
+        end = end == mMappingSize ? end : end - end % pageSize;
+    }
+    if (begin >= end) {
+        return Result::success();
+    }
+    if (madvise(static_cast<char *>(mMapping) + begin, end - begin, advice) != 0) {
+        return Result(AdviceError) << "madvise " << advice << " on " << mFileName
+                                   << ErrnoResult(errno);
+    }
+    return Result::success();
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::prefetch(uint64_t position, size_t valueNb)
+{
+    return advise(position, valueNb, MADV_WILLNEED, true);
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::release(uint64_t position, size_t valueNb)
+{
+    return advise(position, valueNb, MADV_DONTNEED, false);
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::map()
+{
+    Result res = open(O_RDONLY);
+    if (res.isFailure()) {
+        return res;
+    }
+    if (mWritable) {
+        return Result(Unknown) << mFileName << " is mapped for writing";
+    }
+    if (mFileSize > std::numeric_limits<size_t>::max()) {
+        return Result(MemoryError) << mFileName << " is too large to be mapped whole";
+    }
+    mWindowValueNb = 0;
+
+    return mapRange(0, getFileValueNb());
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::mapWindow(size_t windowValueNb,
+                                                        size_t overlapValueNb,
+                                                        uint64_t position)
+{
+    if (windowValueNb == 0 || overlapValueNb >= windowValueNb) {
+        return Result(Unknown) << "invalid window of " << windowValueNb
+                               << " values overlapping by " << overlapValueNb;
+    }
+    Result res = open(O_RDONLY);
+    if (res.isFailure()) {
+        return res;
+    }
+    if (mWritable) {
+        return Result(Unknown) << mFileName << " is mapped for writing";
+    }
+    if (position >= getFileValueNb()) {
+        return Result(EndOfFile) << mFileName << " has " << getFileValueNb() << " values";
+    }
+    mWindowValueNb = windowValueNb;
+    mWindowHopNb = windowValueNb - overlapValueNb;
+
+    return mapRange(position, std::min<uint64_t>(windowValueNb, getFileValueNb() - position));
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::nextWindow()
+{
+    if (mFileState != Mapped || mWindowValueNb == 0) {
+        return Result(Unknown) << "no window mapped";
+    }
+    if (mPosition + mMappedValueNb >= getFileValueNb()) {
+        return Result(EndOfFile);
+    }
+    uint64_t position = mPosition + mWindowHopNb;
+
+    return mapRange(position, std::min<uint64_t>(mWindowValueNb, getFileValueNb() - position));
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::create(size_t valueNb)
+{
+    if (mFileState != Closed) {
+        return Result(Unknown) << mFileName << " is already opened";
+    }
+    Result res = open(O_RDWR | O_CREAT | O_TRUNC);
+    if (res.isFailure()) {
+        return res;
+    }
+    mWritable = true;
+
+    return resize(valueNb);
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::resize(size_t valueNb)
+{
+    using utilities::result::ErrnoResult;
+
+    if (not mWritable) {
+        return Result(Unknown) << mFileName << " is not created";
+    }
+    if (valueNb == 0) {
+        return Result(Unknown) << "can not map an empty file";
+    }
+    uint64_t fileSize = uint64_t(valueNb) * sizeof(T);
+    if (ftruncate64(mFileDescriptor, fileSize) != 0) {
+        return Result(MemoryError) << "while resizing " << mFileName << ErrnoResult(errno);
+    }
+    mFileSize = fileSize;
+
+    if (mFileState != Mapped) {
+        return mapRange(0, valueNb);
+    }
+    void *mapping = mremap(mMapping, mMappingSize, valueNb * sizeof(T), MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) {
+        return Result(MemoryError) << "while remapping " << mFileName << ErrnoResult(errno);
+    }
+    mMapping = mapping;
+    mMappingSize = valueNb * sizeof(T);
+    mMappedFile = static_cast<T *>(mapping);
+    mMappedValueNb = valueNb;
+
+    return adviseMapping();
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::sync(SyncMode mode)
+{
+    using utilities::result::ErrnoResult;
+
+    if (mFileState != Mapped || not mWritable) {
+        return Result(Unknown) << mFileName << " is not created";
+    }
+    if (msync(mMapping, mMappingSize, mode == Synchronous ? MS_SYNC : MS_ASYNC) != 0) {
+        return Result(MemoryError) << "while syncing " << mFileName << ErrnoResult(errno);
+    }
+    return Result::success();
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::follow()
+{
+    Result res = open(O_RDONLY);
+    if (res.isFailure()) {
+        return res;
+    }
+    if (mWritable || mFollowing || mFileState == Mapped) {
+        return Result(Unknown) << mFileName << " is already mapped";
+    }
+    mFollowing = true;
+    mWindowValueNb = 0;
+
+    // Without inotify, the file size is polled
+    mInotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mInotifyDescriptor >= 0 &&
+        inotify_add_watch(mInotifyDescriptor, mFileName, IN_MODIFY) < 0) {
+        close(mInotifyDescriptor);
+        mInotifyDescriptor = -1;
+    }
+
+    size_t newValueNb;
+    return extendMapping(newValueNb);
+}
+
+template <class T>
+int64_t FileMapper<T>::getTimeMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::extendMapping(size_t &newValueNb)
+{
+    using utilities::result::ErrnoResult;
+
+    newValueNb = 0;
+    struct stat64 fileStat;
+    if ((fstat64(mFileDescriptor, &fileStat) == -1)) {
+        return Result(Unknown) << "fstat fails on" << mFileName << ErrnoResult(errno);
+    }
+    mFileSize = fileStat.st_size;
+    if (getFileValueNb() > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        return Result(MemoryError) << mFileName << " is too large to be mapped whole";
+    }
+    size_t valueNb = getFileValueNb();
+    if (valueNb <= mMappedValueNb) {
+        return Result::success();
+    }
+    if (mFileState != Mapped) {
+        newValueNb = valueNb;
+        return mapRange(0, valueNb);
+    }
+
+    void *mapping = mremap(mMapping, mMappingSize, valueNb * sizeof(T), MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) {
+        return Result(MemoryError) << "while remapping " << mFileName << ErrnoResult(errno);
+    }
+    newValueNb = valueNb - mMappedValueNb;
+    mMapping = mapping;
+    mMappingSize = valueNb * sizeof(T);
+    mMappedFile = static_cast<T *>(mapping);
+    mMappedValueNb = valueNb;
+
+    return adviseMapping();
+}
+
+template <class T>
+typename FileMapper<T>::Result FileMapper<T>::waitForValues(int timeoutMs, size_t &newValueNb)
+{
+    using utilities::result::ErrnoResult;
+
+    /** Period of the file size polling when inotify is not available */
+    static const int pollingPeriodMs = 10;
+
+    newValueNb = 0;
+    if (not mFollowing) {
+        return Result(Unknown) << mFileName << " is not followed";
+    }
+    const int64_t deadline = getTimeMs() + timeoutMs;
+    while (true) {
+        Result res = extendMapping(newValueNb);
+        if (res.isFailure() || newValueNb > 0) {
+            return res;
+        }
+        int remainingMs = timeoutMs < 0 ? -1 : int(std::max<int64_t>(deadline - getTimeMs(), 0));
+        if (remainingMs == 0) {
+            return Result::success();
+        }
+
+        if (mInotifyDescriptor < 0) {
+            usleep(1000 * (remainingMs < 0 ? pollingPeriodMs
+                                           : std::min(remainingMs, pollingPeriodMs)));
+            continue;
+        }
+        struct pollfd notification = { mInotifyDescriptor, POLLIN, 0 };
+        if (poll(&notification, 1, remainingMs) < 0 && errno != EINTR) {
+            return Result(Unknown) << "poll fails on " << mFileName << ErrnoResult(errno);
+        }
+        // Drain the events, the file size tells what changed
+        char events[4096];
+        while (read(mInotifyDescriptor, events, sizeof(events)) > 0) {
+        }
+    }
+}
+
 }
 }
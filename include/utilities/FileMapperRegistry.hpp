@@ -0,0 +1,334 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "utilities/FileMapper.hpp"
+#include "result/ErrnoResult.hpp"
+#include "AudioNonCopyable.hpp"
+#include "Mutex.hpp"
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <map>
+#include <string>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+
+template <class T>
+class SharedFileMapping;
+
+/** Process wide cache of read-only file mappings.
+ *
+ *  Each file is opened and mapped once, whatever the number of threads
+ *  using it: mappings are handed out as reference counted SharedFileMapping
+ *  and unmapped with the last of them.
+ *  Files are identified by path, device, inode, size and modification time:
+ *  a file changed on disk is mapped again on the next acquire.
+ *  The views of the previous version stay valid until released only if the
+ *  file was replaced by a rename, the old inode living on. A file rewritten
+ *  in place changes under its views: once truncated, they read zeros or get
+ *  SIGBUS beyond its new end.
+ *
+ *  tparam T the type of the resulting data arrays
+ */
+template <class T>
+class FileMapperRegistry : private NonCopyable
+{
+public:
+    typedef typename FileMapper<T>::Result Result;
+
+    /** @return the registry of the process. */
+    static FileMapperRegistry &getInstance();
+
+    /** Get a view on a file, mapping it if needed.
+     *
+     *  @param[in] fileName the name of the file to map.
+     *  @param[out] mapping view of the file, left untouched on failure.
+     *  @return the Result of the mapping, @see FileMapper::map.
+     */
+    Result acquire(const std::string &fileName, SharedFileMapping<T> &mapping);
+
+    /** @return the number of files currently mapped. */
+    size_t getMappedFileNb();
+
+private:
+    friend class SharedFileMapping<T>;
+
+    /** Identity of a version of a file. */
+    struct FileIdentity
+    {
+        dev_t device;
+        ino64_t inode;
+        off64_t size;
+        time_t modificationSeconds;
+        long modificationNanoseconds;
+
+        bool operator==(const FileIdentity &other) const
+        {
+            return device == other.device && inode == other.inode && size == other.size &&
+                   modificationSeconds == other.modificationSeconds &&
+                   modificationNanoseconds == other.modificationNanoseconds;
+        }
+    };
+
+    /** A mapped file version, deleted with its last view. */
+    struct Entry
+    {
+        explicit Entry(const std::string &name) : fileName(name), mapper(fileName.c_str()) {}
+
+        const std::string fileName;
+        FileMapper<T> mapper;
+        FileIdentity identity;
+        size_t referenceNb;
+    };
+
+    typedef std::map<std::string, Entry *> Entries;
+
+    FileMapperRegistry() {}
+
+    /** @return the identity of a file on disk, by path. */
+    static Result identify(const std::string &fileName, FileIdentity &identity);
+
+    /** @return the identity of the file mapped by an entry, by descriptor. */
+    static Result identify(const Entry &entry, FileIdentity &identity);
+
+    static void setIdentity(const struct stat64 &fileStat, FileIdentity &identity);
+
+    /** Count a new view of an entry. */
+    void addReference(Entry *entry);
+
+    /** Forget a view of an entry, deleting it with the last one. */
+    void removeReference(Entry *entry);
+
+    Mutex mMutex;
+    /** Current version of each mapped file */
+    Entries mEntries;
+};
+
+/** Read-only view of a file mapped by the FileMapperRegistry.
+ *
+ *  Copies share the same mapping, which is released with the last of them.
+ *  The views of a same file can be used from different threads.
+ */
+template <class T>
+class SharedFileMapping
+{
+public:
+    typedef typename FileMapperRegistry<T>::Result Result;
+
+    /** An empty view, @see FileMapperRegistry::acquire. */
+    SharedFileMapping() : mEntry(NULL) {}
+
+    SharedFileMapping(const SharedFileMapping &other);
+
+    SharedFileMapping &operator=(const SharedFileMapping &other);
+
+    ~SharedFileMapping() { reset(); }
+
+    /** Release the view, the view becoming empty. */
+    void reset();
+
+    /** @return the mapped values, NULL if the view is empty. */
+    const T *getMappedFile() const
+    {
+        return mEntry != NULL ? mEntry->mapper.getMappedFile() : NULL;
+    }
+
+    /** @return the number of mapped values, 0 if the view is empty. */
+    size_t getMappedFileSize() const
+    {
+        return mEntry != NULL ? mEntry->mapper.getMappedFileSize() : 0;
+    }
+
+    /** @return false if the file changed on disk since it was mapped. */
+    bool isUpToDate() const;
+
+private:
+    friend class FileMapperRegistry<T>;
+    typedef typename FileMapperRegistry<T>::Entry Entry;
+
+    /** Release the current entry and take an entry whose reference is
+     *  already counted for this view. */
+    void adopt(Entry *entry)
+    {
+        reset();
+        mEntry = entry;
+    }
+
+    Entry *mEntry;
+};
+
+template <class T>
+FileMapperRegistry<T> &FileMapperRegistry<T>::getInstance()
+{
+    static FileMapperRegistry registry;
+    return registry;
+}
+
+template <class T>
+typename FileMapperRegistry<T>::Result FileMapperRegistry<T>::identify(
+    const std::string &fileName, FileIdentity &identity)
+{
+    using utilities::result::ErrnoResult;
+
+    struct stat64 fileStat;
+    if (stat64(fileName.c_str(), &fileStat) != 0) {
+        return Result(FileMapper<T>::NoSuchFile) << fileName << ErrnoResult(errno);
+    }
+    setIdentity(fileStat, identity);
+    return Result::success();
+}
+
+template <class T>
+typename FileMapperRegistry<T>::Result FileMapperRegistry<T>::identify(
+    const Entry &entry, FileIdentity &identity)
+{
+    using utilities::result::ErrnoResult;
+
+    struct stat64 fileStat;
+    if (fstat64(entry.mapper.getFileDescriptor(), &fileStat) != 0) {
+        return Result(FileMapper<T>::Unknown) << "fstat fails on " << entry.fileName
+                                              << ErrnoResult(errno);
+    }
+    setIdentity(fileStat, identity);
+    return Result::success();
+}
+
+template <class T>
+void FileMapperRegistry<T>::setIdentity(const struct stat64 &fileStat, FileIdentity &identity)
+{
+    identity.device = fileStat.st_dev;
+    identity.inode = fileStat.st_ino;
+    identity.size = fileStat.st_size;
+    identity.modificationSeconds = fileStat.st_mtim.tv_sec;
+    identity.modificationNanoseconds = fileStat.st_mtim.tv_nsec;
+}
+
+template <class T>
+typename FileMapperRegistry<T>::Result FileMapperRegistry<T>::acquire(
+    const std::string &fileName, SharedFileMapping<T> &mapping)
+{
+    FileIdentity identity;
+    Result res = identify(fileName, identity);
+    if (res.isFailure()) {
+        return res;
+    }
+
+    Entry *entry = NULL;
+    {
+        Mutex::Locker locker(mMutex);
+
+        typename Entries::iterator found = mEntries.find(fileName);
+        if (found != mEntries.end() && found->second->identity == identity) {
+            entry = found->second;
+            entry->referenceNb++;
+        } else {
+            // An outdated entry lives as long as its views
+            entry = new Entry(fileName);
+            res = entry->mapper.map();
+            if (res.isSuccess()) {
+                // The path may have been replaced since it was identified:
+                // identify what is actually mapped
+                res = identify(*entry, entry->identity);
+            }
+            if (res.isFailure()) {
+                delete entry;
+                return res;
+            }
+            entry->referenceNb = 1;
+            mEntries[fileName] = entry;
+        }
+    }
+    // Releasing the previous view of mapping takes the lock
+    mapping.adopt(entry);
+    return Result::success();
+}
+
+template <class T>
+size_t FileMapperRegistry<T>::getMappedFileNb()
+{
+    Mutex::Locker locker(mMutex);
+    return mEntries.size();
+}
+
+template <class T>
+void FileMapperRegistry<T>::addReference(Entry *entry)
+{
+    Mutex::Locker locker(mMutex);
+    entry->referenceNb++;
+}
+
+template <class T>
+void FileMapperRegistry<T>::removeReference(Entry *entry)
+{
+    Mutex::Locker locker(mMutex);
+    if (--entry->referenceNb > 0) {
+        return;
+    }
+    typename Entries::iterator found = mEntries.find(entry->fileName);
+    if (found != mEntries.end() && found->second == entry) {
+        mEntries.erase(found);
+    }
+    delete entry;
+}
+
+template <class T>
+SharedFileMapping<T>::SharedFileMapping(const SharedFileMapping &other)
+    : mEntry(other.mEntry)
+{
+    if (mEntry != NULL) {
+        FileMapperRegistry<T>::getInstance().addReference(mEntry);
+    }
+}
+
+template <class T>
+SharedFileMapping<T> &SharedFileMapping<T>::operator=(const SharedFileMapping &other)
+{
+    // Referenced before the release, other may be this view
+    Entry *entry = other.mEntry;
+    if (entry != NULL) {
+        FileMapperRegistry<T>::getInstance().addReference(entry);
+    }
+    adopt(entry);
+    return *this;
+}
+
+template <class T>
+void SharedFileMapping<T>::reset()
+{
+    if (mEntry != NULL) {
+        FileMapperRegistry<T>::getInstance().removeReference(mEntry);
+        mEntry = NULL;
+    }
+}
+
+template <class T>
+bool SharedFileMapping<T>::isUpToDate() const
+{
+    if (mEntry == NULL) {
+        return false;
+    }
+    typename FileMapperRegistry<T>::FileIdentity identity;
+    return FileMapperRegistry<T>::identify(mEntry->fileName, identity).isSuccess() &&
+           identity == mEntry->identity;
+}
+
+}
+}
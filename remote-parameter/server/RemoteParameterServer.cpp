@@ -26,7 +26,7 @@
 using std::string;
 
 RemoteParameterServer::RemoteParameterServer()
-    : mEventThread(new CEventThread(this)),
+    : mEventThread(new CEventThread(this, true, CEventThread::EEpollBackend)),
       mFdClientId(0),
       mStarted(false)
 {
@@ -94,8 +94,8 @@ bool RemoteParameterServer::addRemoteParameter(RemoteParameterBase *remoteParame
     // Record parameter
     mRemoteParameterImplMap[implementor->getPollFd()] = implementor;
 
-    // Listen to new server requests
-    mEventThread->addOpenedFd(mFdClientId++, implementor->getPollFd(), true);
+    // Listen to new server requests, the implementor being given back with them
+    mEventThread->addOpenedFd(mFdClientId++, implementor->getPollFd(), true, implementor);
 
     return true;
 }
@@ -154,6 +154,16 @@ bool RemoteParameterServer::onEvent(int fd)
     return false;
 }
 
+bool RemoteParameterServer::onReadable(int /*fd*/, void *context)
+{
+    ALOGD("%s", __FUNCTION__);
+
+    // Process request of the server given when listening to it
+    static_cast<RemoteParameterImpl *>(context)->handleNewConnection();
+
+    return false;
+}
+
 bool RemoteParameterServer::onError(int fd)
 {
     // Nothing to do
@@ -70,6 +70,7 @@ private:
      * Event processing - From IEventListener
      */
     virtual bool onEvent(int fd);
+    virtual bool onReadable(int fd, void *context);
     virtual bool onError(int fd);
     virtual bool onHangup(int fd);
     virtual void onAlarm();
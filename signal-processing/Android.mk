@@ -51,7 +51,16 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libaudio_utilities_signal_processing_unit_test_host
 
-LOCAL_SRC_FILES := test/SignalProcessingUnitTest.cpp
+LOCAL_SRC_FILES := \
+    test/SignalProcessingUnitTest.cpp \
+    test/FftUnitTest.cpp \
+    test/SimdKernelsUnitTest.cpp \
+    test/StreamingCorrelatorUnitTest.cpp \
+    test/CorrelationWorkspaceUnitTest.cpp \
+    test/ToneDetectorUnitTest.cpp \
+    test/LevelMeterUnitTest.cpp \
+    test/SpectrumAnalyzerUnitTest.cpp \
+    test/WavReaderUnitTest.cpp
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
 
 LOCAL_CFLAGS := -Wall -Werror -Wextra -ggdb3 -O0
@@ -73,7 +82,16 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := libaudio_utilities_signal_processing_unit_test
 
-LOCAL_SRC_FILES := test/SignalProcessingUnitTest.cpp
+LOCAL_SRC_FILES := \
+    test/SignalProcessingUnitTest.cpp \
+    test/FftUnitTest.cpp \
+    test/SimdKernelsUnitTest.cpp \
+    test/StreamingCorrelatorUnitTest.cpp \
+    test/CorrelationWorkspaceUnitTest.cpp \
+    test/ToneDetectorUnitTest.cpp \
+    test/LevelMeterUnitTest.cpp \
+    test/SpectrumAnalyzerUnitTest.cpp \
+    test/WavReaderUnitTest.cpp
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
 
@@ -87,3 +105,46 @@ LOCAL_STATIC_LIBRARIES := \
 
 include $(BUILD_NATIVE_TEST)
 
+#########################
+# host benchmark
+ifeq (ENABLE_HOST_VERSION,1)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libaudio_utilities_signal_processing_benchmark_host
+
+LOCAL_SRC_FILES := \
+    benchmark/SignalProcessingBenchmark.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -O2
+
+LOCAL_STATIC_LIBRARIES := \
+    libacresult_host \
+    libaudio_utilities_host
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
+endif
+#########################
+# target benchmark
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := libaudio_utilities_signal_processing_benchmark
+
+LOCAL_SRC_FILES := \
+    benchmark/SignalProcessingBenchmark.cpp
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := -Wall -Werror -Wextra -O2
+
+LOCAL_STATIC_LIBRARIES := \
+    libacresult \
+    libaudio_utilities
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
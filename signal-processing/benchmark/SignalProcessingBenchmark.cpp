@@ -0,0 +1,203 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** Benchmark of the SignalProcessing kernels.
+ *
+ *  Prints one CSV line per kernel, type, signal length and delay window:
+ *      kernel,type,values,delays,iterations,ns_per_value,gb_per_s
+ *  Times are the best of several iterations. Bandwidth is computed from the
+ *  size of the signals read by one call.
+ *
+ *  Usage: signal_processing_benchmark [maxValueNb [maxDelayNb]]
+ */
+
+#include "signal-processing/SignalProcessing.hpp"
+#include "signal-processing/LevelMeter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+using namespace audio_utilities::utilities::signal_processing;
+
+namespace
+{
+
+/** Total time spent on one measure, to average out the timer resolution. */
+const uint64_t minMeasureNs = 50 * 1000 * 1000;
+const size_t minIterationNb = 3;
+
+const size_t valueNbs[] = { 1000, 10000, 100000, 1000000, 10000000 };
+const size_t delayNbs[] = { 10, 100, 1000, 10000 };
+
+/** Results are accumulated here so that the compiler can not drop the calls. */
+volatile double sink;
+
+uint64_t getTimeNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+template <class T>
+struct TypeName;
+
+template <>
+struct TypeName<int8_t> { static const char *get() { return "int8"; } };
+template <>
+struct TypeName<int16_t> { static const char *get() { return "int16"; } };
+template <>
+struct TypeName<int32_t> { static const char *get() { return "int32"; } };
+template <>
+struct TypeName<float> { static const char *get() { return "float"; } };
+
+/** Value spanning the whole range of a type from 32 random bits,
+ *  [-1, 1[ for float. */
+template <class T>
+struct FullRange;
+
+template <>
+struct FullRange<int8_t> { static int8_t get(uint32_t bits) { return int8_t(bits >> 24); } };
+template <>
+struct FullRange<int16_t> { static int16_t get(uint32_t bits) { return int16_t(bits >> 16); } };
+template <>
+struct FullRange<int32_t> { static int32_t get(uint32_t bits) { return int32_t(bits); } };
+template <>
+struct FullRange<float>
+{
+    static float get(uint32_t bits) { return int32_t(bits) / 2147483648.f; }
+};
+
+/** The kernels benchmarked, each call returns a value to sink. */
+template <class T>
+struct Kernels
+{
+    typedef SignalProcessing<T> Processing;
+
+    const T *signalA;
+    const T *signalB;
+    size_t valueNb;
+    size_t delayNb;
+
+    double mean() const { return Processing::mean(signalA, valueNb); }
+
+    double variance() const { return Processing::variance(1, signalA, valueNb); }
+
+    double normalizedOffsetProduct() const
+    {
+        return Processing::normalizedOffsetProduct(1, 2, signalA, signalB, valueNb, 1);
+    }
+
+    double crossCorrelate() const
+    {
+        typename Processing::CrossCorrelationResult result;
+        Processing::cross_correlate(signalA, signalB, valueNb, result, 0, delayNb - 1);
+        return result.coefficient + result.delay;
+    }
+
+    /** 10 ms blocks at 48 kHz */
+    double levels() const
+    {
+        std::vector<typename LevelMeter<T>::Levels> blockLevels;
+        LevelMeter<T>::measure(signalA, valueNb, 480, blockLevels);
+        return blockLevels.back().rms;
+    }
+};
+
+/** Time a kernel and print its line. */
+template <class T>
+void measure(const char *name, double (Kernels<T>::*kernel)() const,
+             const Kernels<T> &kernels, size_t signalNb)
+{
+    uint64_t bestNs = std::numeric_limits<uint64_t>::max();
+    uint64_t totalNs = 0;
+    size_t iterationNb = 0;
+    while (iterationNb < minIterationNb || totalNs < minMeasureNs) {
+        uint64_t start = getTimeNs();
+        sink = sink + (kernels.*kernel)();
+        uint64_t durationNs = getTimeNs() - start;
+
+        bestNs = std::min(bestNs, durationNs);
+        totalNs += durationNs;
+        iterationNb++;
+    }
+
+    double bytes = double(signalNb) * kernels.valueNb * sizeof(T);
+    printf("%s,%s,%zu,%zu,%zu,%.4f,%.4f\n", name, TypeName<T>::get(),
+           kernels.valueNb, kernels.delayNb, iterationNb,
+           double(bestNs) / kernels.valueNb, bytes / bestNs);
+    fflush(stdout);
+}
+
+template <class T>
+void benchmark(size_t maxValueNb, size_t maxDelayNb)
+{
+    for (size_t v = 0; v < sizeof(valueNbs) / sizeof(valueNbs[0]); v++) {
+        size_t valueNb = valueNbs[v];
+        if (valueNb > maxValueNb) {
+            break;
+        }
+
+        std::vector<T> signalA(valueNb);
+        std::vector<T> signalB(valueNb);
+        uint32_t state = 1;
+        for (size_t i = 0; i < valueNb; i++) {
+            state = state * 1664525u + 1013904223u;
+            signalA[i] = FullRange<T>::get(state);
+            state = state * 1664525u + 1013904223u;
+            signalB[i] = FullRange<T>::get(state);
+        }
+
+        Kernels<T> kernels = { &signalA[0], &signalB[0], valueNb, 0 };
+        measure("mean", &Kernels<T>::mean, kernels, 1);
+        measure("variance", &Kernels<T>::variance, kernels, 1);
+        measure("normalizedOffsetProduct", &Kernels<T>::normalizedOffsetProduct, kernels, 2);
+        measure("levels", &Kernels<T>::levels, kernels, 1);
+
+        for (size_t d = 0; d < sizeof(delayNbs) / sizeof(delayNbs[0]); d++) {
+            kernels.delayNb = delayNbs[d];
+            if (kernels.delayNb > maxDelayNb || kernels.delayNb >= valueNb) {
+                break;
+            }
+            measure("cross_correlate", &Kernels<T>::crossCorrelate, kernels, 2);
+        }
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    size_t maxValueNb = argc > 1 ? strtoul(argv[1], NULL, 0) : valueNbs[4];
+    size_t maxDelayNb = argc > 2 ? strtoul(argv[2], NULL, 0) : delayNbs[3];
+
+    printf("# simd level %s\n", details::getSimdLevelName(details::getSimdLevel()));
+    printf("kernel,type,values,delays,iterations,ns_per_value,gb_per_s\n");
+
+    benchmark<int8_t>(maxValueNb, maxDelayNb);
+    benchmark<int16_t>(maxValueNb, maxDelayNb);
+    benchmark<int32_t>(maxValueNb, maxDelayNb);
+    benchmark<float>(maxValueNb, maxDelayNb);
+
+    return EXIT_SUCCESS;
+}
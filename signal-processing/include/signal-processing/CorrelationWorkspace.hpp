@@ -0,0 +1,169 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "signal-processing/SignalProcessing.hpp"
+#include <AudioNonCopyable.hpp>
+#include <vector>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Resources to correlate signals of a given size over a given delay range.
+ *
+ *  The transform, its twiddle factors and all the working memory are
+ *  allocated at construction, correlations through a workspace do not
+ *  allocate. They can thus be run repeatedly on same sized windows from a
+ *  real time thread.
+ *  A workspace must not be used by several threads at the same time.
+ *
+ *  Results are the same as the SignalProcessing methods of the same name.
+ *
+ *  @tparam T the type of the array used to carry the signal.
+ */
+template <class T>
+class CorrelationWorkspace : private NonCopyable
+{
+public:
+    typedef SignalProcessing<T> Processing;
+    typedef typename Processing::Result Result;
+    typedef typename Processing::CrossCorrelationResult CrossCorrelationResult;
+
+    /**
+     *  @param[in] valueNb number of values of the correlated signals.
+     *  @param[in] minDelay minimum delay searched, @see SignalProcessing::cross_correlate.
+     *  @param[in] maxDelay maximum delay searched, @see SignalProcessing::cross_correlate.
+     */
+    CorrelationWorkspace(size_t valueNb, ssize_t minDelay, ssize_t maxDelay);
+
+    /** @see SignalProcessing::cross_correlate, signals must have getValueNb() values. */
+    Result cross_correlate(const T *signalA, const T *signalB, CrossCorrelationResult &result);
+
+    /** @see SignalProcessing::cross_correlate_direct */
+    Result cross_correlate_direct(const T *signalA, const T *signalB,
+                                  CrossCorrelationResult &result);
+
+    /** @see SignalProcessing::cross_correlate_fft */
+    Result cross_correlate_fft(const T *signalA, const T *signalB,
+                               CrossCorrelationResult &result);
+
+    /** @see SignalProcessing::cross_correlate_phat */
+    Result cross_correlate_phat(const T *signalA, const T *signalB,
+                                CrossCorrelationResult &result);
+
+    size_t getValueNb() const { return mValueNb; }
+
+private:
+    typedef typename Processing::Normalization Normalization;
+
+    /** Correlate in the frequency domain with a given cross spectrum weighting. */
+    Result correlateSpectra(const T *signalA, const T *signalB, CrossCorrelationResult &result,
+                            typename Processing::CrossSpectrumWeighting weighting);
+
+    const size_t mValueNb;
+    const ssize_t mMinDelay;
+    const ssize_t mMaxDelay;
+
+    /** Delay range restricted to the delays where the signals overlap. */
+    ssize_t mOverlapMinDelay;
+    ssize_t mOverlapMaxDelay;
+    bool mOverlap;
+
+    RealFft mFft;
+    std::vector<RealFft::Complex> mSpectrumA;
+    std::vector<RealFft::Complex> mSpectrumB;
+};
+
+template <class T>
+CorrelationWorkspace<T>::CorrelationWorkspace(size_t valueNb, ssize_t minDelay, ssize_t maxDelay)
+    : mValueNb(valueNb), mMinDelay(minDelay), mMaxDelay(maxDelay),
+      mOverlapMinDelay(minDelay), mOverlapMaxDelay(maxDelay),
+      mOverlap(Processing::clampDelays(valueNb, mOverlapMinDelay, mOverlapMaxDelay)),
+      mFft(Processing::getCorrelationFftSize(valueNb, minDelay, maxDelay)),
+      mSpectrumA(mFft.getSpectrumSize()),
+      mSpectrumB(mFft.getSpectrumSize())
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+}
+
+template <class T>
+typename CorrelationWorkspace<T>::Result CorrelationWorkspace<T>::cross_correlate(
+    const T *signalA, const T *signalB, CrossCorrelationResult &result)
+{
+    if (Processing::isFftPreferred(mValueNb, mMinDelay, mMaxDelay)) {
+        return cross_correlate_fft(signalA, signalB, result);
+    }
+    return cross_correlate_direct(signalA, signalB, result);
+}
+
+template <class T>
+typename CorrelationWorkspace<T>::Result CorrelationWorkspace<T>::cross_correlate_direct(
+    const T *signalA, const T *signalB, CrossCorrelationResult &result)
+{
+    // The direct correlation does not need any memory
+    return Processing::cross_correlate_direct(signalA, signalB, mValueNb, result,
+                                              mMinDelay, mMaxDelay);
+}
+
+template <class T>
+typename CorrelationWorkspace<T>::Result CorrelationWorkspace<T>::cross_correlate_fft(
+    const T *signalA, const T *signalB, CrossCorrelationResult &result)
+{
+    return correlateSpectra(signalA, signalB, result, Processing::NoWeighting);
+}
+
+template <class T>
+typename CorrelationWorkspace<T>::Result CorrelationWorkspace<T>::cross_correlate_phat(
+    const T *signalA, const T *signalB, CrossCorrelationResult &result)
+{
+    return correlateSpectra(signalA, signalB, result, Processing::PhaseTransform);
+}
+
+template <class T>
+typename CorrelationWorkspace<T>::Result CorrelationWorkspace<T>::correlateSpectra(
+    const T *signalA, const T *signalB, CrossCorrelationResult &result,
+    typename Processing::CrossSpectrumWeighting weighting)
+{
+    Normalization normalization;
+    Result status = Processing::normalize(signalA, signalB, mValueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+    result.coefficient = 0;
+    // Will be overwriten as for any x, x > maxCorrelationCoef (result.coefficient)
+    result.delay = std::numeric_limits<ssize_t>::max();
+
+    if (not mOverlap) {
+        return Result::success();
+    }
+    Processing::correlateSpectra(mFft, normalization, signalA, signalB, mValueNb,
+                                 mOverlapMinDelay, mOverlapMaxDelay,
+                                 &mSpectrumA[0], &mSpectrumB[0], result, weighting);
+
+    return Result::success();
+}
+
+}
+}
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <AudioUtilitiesAssert.hpp>
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Radix-2 Fast Fourier Transform of real signals.
+ *
+ *  A real signal of size N is transformed through a complex FFT of size N/2
+ *  (even samples as real part, odd samples as imaginary part) followed by a
+ *  split step. All twiddle factors and the bit reversal permutation are
+ *  computed once at construction, transforms do not allocate.
+ *
+ *  The spectrum of a real signal is hermitian, thus only its N/2 + 1 first
+ *  bins are stored.
+ */
+class RealFft
+{
+public:
+    typedef std::complex<double> Complex;
+
+    /** @param[in] size of the transform, must be a power of two greater or equal to 2. */
+    explicit RealFft(size_t size);
+
+    /** @return the size of the real signals handled by the transform. */
+    size_t getSize() const { return mSize; }
+
+    /** @return the number of bins of a spectrum: getSize() / 2 + 1. */
+    size_t getSpectrumSize() const { return mSize / 2 + 1; }
+
+    /** Forward (unnormalized) transform.
+     *
+     *  @param[in] input real signal of getSize() values. May be the spectrum
+     *                   itself, seen as an array of doubles, to transform in place.
+     *  @param[out] spectrum of getSpectrumSize() bins.
+     */
+    void forward(const double *input, Complex *spectrum) const;
+
+    /** Inverse transform, normalized so that inverse(forward(x)) == x.
+     *
+     *  @param[in,out] spectrum of getSpectrumSize() bins, used as working
+     *                 memory thus overwritten.
+     *  @param[out] output real signal of getSize() values. May be the spectrum
+     *                    itself, seen as an array of doubles.
+     */
+    void inverse(Complex *spectrum, double *output) const;
+
+    /** @return the smallest power of two greater or equal to value (and to 2). */
+    static size_t nextPowerOfTwo(size_t value);
+
+private:
+    /** In place complex FFT of size mSize / 2. */
+    void complexTransform(Complex *data, bool inverse) const;
+
+    size_t mSize;
+
+    /** exp(-2iPI * k / (mSize / 2)) for k in [0, mSize / 4[ */
+    std::vector<Complex> mTwiddles;
+
+    /** exp(-2iPI * k / mSize) for k in [0, mSize / 2[, used by the split step */
+    std::vector<Complex> mSplitTwiddles;
+
+    /** Bit reversal permutation of the complex transform */
+    std::vector<size_t> mBitReverse;
+};
+
+inline RealFft::RealFft(size_t size)
+    : mSize(size)
+{
+    AUDIOUTILITIES_ASSERT(size >= 2 && (size & (size - 1)) == 0,
+                          "FFT size must be a power of two: " << size);
+
+    const size_t half = mSize / 2;
+
+    mTwiddles.resize(std::max<size_t>(half / 2, 1));
+    for (size_t k = 0; k < mTwiddles.size(); k++) {
+        mTwiddles[k] = std::polar(1.0, -2 * M_PI * k / half);
+    }
+
+    mSplitTwiddles.resize(half);
+    for (size_t k = 0; k < half; k++) {
+        mSplitTwiddles[k] = std::polar(1.0, -2 * M_PI * k / mSize);
+    }
+
+    mBitReverse.resize(half);
+    size_t bitNb = 0;
+    while ((size_t(1) << bitNb) < half) {
+        bitNb++;
+    }
+    for (size_t i = 0; i < half; i++) {
+        size_t reversed = 0;
+        for (size_t bit = 0; bit < bitNb; bit++) {
+            if (i & (size_t(1) << bit)) {
+                reversed |= size_t(1) << (bitNb - 1 - bit);
+            }
+        }
+        mBitReverse[i] = reversed;
+    }
+}
+
+inline size_t RealFft::nextPowerOfTwo(size_t value)
+{
+    size_t power = 2;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+inline void RealFft::complexTransform(Complex *data, bool inverse) const
+{
+    const size_t size = mSize / 2;
+
+    for (size_t i = 0; i < size; i++) {
+        size_t j = mBitReverse[i];
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    for (size_t length = 2; length <= size; length <<= 1) {
+        const size_t halfLength = length / 2;
+        const size_t twiddleStep = size / length;
+        for (size_t start = 0; start < size; start += length) {
+            for (size_t k = 0; k < halfLength; k++) {
+                Complex twiddle = mTwiddles[k * twiddleStep];
+                if (inverse) {
+                    twiddle = std::conj(twiddle);
+                }
+                Complex odd = data[start + k + halfLength] * twiddle;
+                data[start + k + halfLength] = data[start + k] - odd;
+                data[start + k] += odd;
+            }
+        }
+    }
+}
+
+inline void RealFft::forward(const double *input, Complex *spectrum) const
+{
+    const size_t half = mSize / 2;
+
+    for (size_t i = 0; i < half; i++) {
+        spectrum[i] = Complex(input[2 * i], input[2 * i + 1]);
+    }
+    complexTransform(spectrum, false);
+
+    // Split step: bins k and half - k are computed together, in place.
+    Complex z0 = spectrum[0];
+    spectrum[0] = Complex(z0.real() + z0.imag(), 0);
+    spectrum[half] = Complex(z0.real() - z0.imag(), 0);
+
+    for (size_t k = 1; k <= half / 2; k++) {
+        Complex zk = spectrum[k];
+        Complex zmk = std::conj(spectrum[half - k]);
+
+        Complex even = (zk + zmk) * 0.5;
+        Complex odd = (zk - zmk) * Complex(0, -0.5) * mSplitTwiddles[k];
+
+        spectrum[k] = even + odd;
+        spectrum[half - k] = std::conj(even - odd);
+    }
+}
+
+inline void RealFft::inverse(Complex *spectrum, double *output) const
+{
+    const size_t half = mSize / 2;
+
+    // Undo the split step, in place.
+    double x0 = spectrum[0].real();
+    double xHalf = spectrum[half].real();
+    spectrum[0] = Complex((x0 + xHalf) * 0.5, (x0 - xHalf) * 0.5);
+
+    for (size_t k = 1; k <= half / 2; k++) {
+        Complex xk = spectrum[k];
+        Complex xmk = std::conj(spectrum[half - k]);
+
+        Complex even = (xk + xmk) * 0.5;
+        Complex odd = (xk - xmk) * 0.5 * std::conj(mSplitTwiddles[k]);
+
+        spectrum[k] = even + Complex(0, 1) * odd;
+        spectrum[half - k] = std::conj(even) + Complex(0, 1) * std::conj(odd);
+    }
+
+    complexTransform(spectrum, true);
+
+    const double scale = 1.0 / half;
+    for (size_t i = 0; i < half; i++) {
+        output[2 * i] = spectrum[i].real() * scale;
+        output[2 * i + 1] = spectrum[i].imag() * scale;
+    }
+}
+
+}
+}
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "signal-processing/SignalProcessing.hpp"
+#include <AudioUtilitiesAssert.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Measure the levels of consecutive blocks of a signal.
+ *
+ *  The signal can be pushed chunk by chunk, blocks spanning several chunks.
+ *  Each value is loaded from memory once: blocks are processed by pieces
+ *  small enough to stay in cache, all the levels of a piece being computed
+ *  by the (vectorized) kernels while it is cached.
+ *
+ *  @tparam T the type of the array used to carry the signal.
+ */
+template <class T>
+class LevelMeter
+{
+public:
+    /** Levels of a block. */
+    struct Levels
+    {
+        /** Root mean square of the values, DC offset included. */
+        float rms;
+        /** Greatest absolute value. */
+        float peak;
+        /** Mean of the values. */
+        float dcOffset;
+        /** Ratio of the values whose sign differs from the previous value's
+         *  one, 0 being positive. */
+        float zeroCrossingRate;
+        /** Number of values whose absolute value reaches the clip level. */
+        uint32_t clippedNb;
+    };
+
+    /**
+     *  @param[in] blockSize number of values per block.
+     *  @param[in] clipLevel absolute value from which values are clipped,
+     *                       the full scale by default: the maximum value of
+     *                       integer types, 1 for float.
+     */
+    explicit LevelMeter(size_t blockSize, T clipLevel = getFullScale());
+
+    /** Process the following values of the signal.
+     *
+     *  @param[out] levels the levels of the blocks completed by this chunk
+     *                     are appended to it.
+     */
+    void push(const T *chunk, size_t valueNb, std::vector<Levels> &levels);
+
+    /** Complete the current block with the values pushed so far.
+     *
+     *  @param[out] levels the levels of the current block are appended to it,
+     *                     if it is not empty.
+     */
+    void flush(std::vector<Levels> &levels);
+
+    /** Measure the levels of the blocks of a whole signal.
+     *
+     *  @param[out] levels the levels of each block, the last one possibly
+     *                     being shorter than blockSize.
+     */
+    static void measure(const T *signal, size_t valueNb, size_t blockSize,
+                        std::vector<Levels> &levels, T clipLevel = getFullScale());
+
+    /** @return the full scale of the signal type. */
+    static T getFullScale()
+    {
+        return std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::max() : T(1);
+    }
+
+private:
+    /** Values processed at once, 16kB of 32 bits values fit in any L1 cache. */
+    static const size_t pieceSize = 4096;
+
+    /** Process values belonging to the current block. */
+    void processPiece(const T *piece, size_t valueNb);
+
+    /** Append the current block levels and start a new block. */
+    void completeBlock(std::vector<Levels> &levels);
+
+    /** Start a new block. */
+    void resetBlock();
+
+    const size_t mBlockSize;
+    const T mClipLevel;
+
+    /** Current block state */
+    size_t mBlockValueNb;
+    details::MomentsAccumulator<T> mMoments;
+    T mMin;
+    T mMax;
+    uint32_t mZeroCrossingNb;
+    uint32_t mClippedNb;
+
+    /** Last value pushed, to detect zero crossings across chunks and blocks. */
+    bool mHasPrevious;
+    bool mPreviousNegative;
+};
+
+template <class T>
+const size_t LevelMeter<T>::pieceSize;
+
+template <class T>
+LevelMeter<T>::LevelMeter(size_t blockSize, T clipLevel)
+    : mBlockSize(blockSize),
+      mClipLevel(clipLevel),
+      mBlockValueNb(0),
+      mMin(std::numeric_limits<T>::max()),
+      mMax(details::lowest<T>()),
+      mZeroCrossingNb(0),
+      mClippedNb(0),
+      mHasPrevious(false),
+      mPreviousNegative(false)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    AUDIOUTILITIES_ASSERT(blockSize > 0, "Level meter block size must not be null");
+    AUDIOUTILITIES_ASSERT(clipLevel > 0, "Level meter clip level must be positive");
+}
+
+template <class T>
+void LevelMeter<T>::push(const T *chunk, size_t valueNb, std::vector<Levels> &levels)
+{
+    while (valueNb > 0) {
+        size_t pieceValueNb = std::min(std::min<size_t>(valueNb, pieceSize),
+                                       mBlockSize - mBlockValueNb);
+        processPiece(chunk, pieceValueNb);
+        chunk += pieceValueNb;
+        valueNb -= pieceValueNb;
+
+        if (mBlockValueNb == mBlockSize) {
+            completeBlock(levels);
+        }
+    }
+}
+
+template <class T>
+void LevelMeter<T>::flush(std::vector<Levels> &levels)
+{
+    if (mBlockValueNb > 0) {
+        completeBlock(levels);
+    }
+}
+
+template <class T>
+void LevelMeter<T>::processPiece(const T *piece, size_t valueNb)
+{
+    details::minMax(piece, valueNb, mMin, mMax);
+    mMoments.add(piece, valueNb);
+    mZeroCrossingNb += details::zeroCrossings(piece, valueNb);
+    mClippedNb += details::clippedValues(piece, valueNb, mClipLevel);
+    if (mHasPrevious) {
+        mZeroCrossingNb += (piece[0] < 0) != mPreviousNegative;
+    }
+
+    mHasPrevious = true;
+    mPreviousNegative = piece[valueNb - 1] < 0;
+    mBlockValueNb += valueNb;
+}
+
+template <class T>
+void LevelMeter<T>::completeBlock(std::vector<Levels> &levels)
+{
+    if (mBlockValueNb > 0) {
+        Levels block;
+        block.rms = sqrt(mMoments.energy() / mBlockValueNb);
+        block.peak = std::max(std::fabs(double(mMin)), std::fabs(double(mMax)));
+        block.dcOffset = mMoments.mean();
+        block.zeroCrossingRate = float(mZeroCrossingNb) / mBlockValueNb;
+        block.clippedNb = mClippedNb;
+        levels.push_back(block);
+    }
+    resetBlock();
+}
+
+template <class T>
+void LevelMeter<T>::resetBlock()
+{
+    mBlockValueNb = 0;
+    mMoments = details::MomentsAccumulator<T>();
+    mMin = std::numeric_limits<T>::max();
+    mMax = details::lowest<T>();
+    mZeroCrossingNb = 0;
+    mClippedNb = 0;
+}
+
+template <class T>
+void LevelMeter<T>::measure(const T *signal, size_t valueNb, size_t blockSize,
+                            std::vector<Levels> &levels, T clipLevel)
+{
+    levels.clear();
+    levels.reserve((valueNb + blockSize - 1) / blockSize);
+
+    LevelMeter<T> meter(blockSize, clipLevel);
+    meter.push(signal, valueNb, levels);
+    meter.flush(levels);
+}
+
+}
+}
+}
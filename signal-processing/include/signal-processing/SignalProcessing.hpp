@@ -15,11 +15,16 @@
  */
 #pragma once
 
+#include "signal-processing/Fft.hpp"
+#include "signal-processing/SimdKernels.hpp"
 #include <result/Result.hpp>
 #include <utilities/FileMapper.hpp>
+#include <utilities/Thread.hpp>
 #include <AudioUtilitiesAssert.hpp>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
+#include <vector>
 
 
 namespace audio_utilities
@@ -42,9 +47,58 @@ template <>
 struct ProcessingAllowed<int16_t> {};
 template <>
 struct ProcessingAllowed<int32_t> {};
+template <>
+struct ProcessingAllowed<float> {};
 
+/** @return the lowest value of a type, std::numeric_limits::min() being the
+ *  smallest positive one for floating point types. */
+template <typename T>
+inline T lowest()
+{
+    return std::numeric_limits<T>::is_integer ?
+           std::numeric_limits<T>::min() : -std::numeric_limits<T>::max();
 }
 
+}
+
+/** Read only view on one channel of an interleaved multi-channel signal.
+ *
+ *  Allows to process a channel in place, without deinterleaving it.
+ */
+template <class T>
+class StridedSignal
+{
+public:
+    /** View on a contiguous (mono) signal. */
+    explicit StridedSignal(const T *signal) : mFirst(signal), mStride(1) {}
+
+    /** View on a channel of frames of channelNb interleaved values. */
+    StridedSignal(const T *frames, size_t channelNb, size_t channel)
+        : mFirst(frames + channel), mStride(channelNb)
+    {
+        AUDIOUTILITIES_ASSERT(channel < channelNb,
+                              "Invalid channel " << channel << " of " << channelNb);
+    }
+
+    /** @return the value of a given index of the channel. */
+    const T &operator[](size_t index) const { return mFirst[index * mStride]; }
+
+    /** @return the first value of the channel. */
+    const T *getFirst() const { return mFirst; }
+
+    /** @return the number of values between two consecutive values of the channel. */
+    size_t getStride() const { return mStride; }
+
+    bool isContiguous() const { return mStride == 1; }
+
+private:
+    const T *mFirst;
+    size_t mStride;
+};
+
+
+template <class T>
+class CorrelationWorkspace;
 
 /** This class allows to cross-correlate two signals
  *
@@ -54,6 +108,7 @@ struct ProcessingAllowed<int32_t> {};
 template <class T>
 class SignalProcessing
 {
+    friend class CorrelationWorkspace<T>;
 
 public:
 
@@ -61,7 +116,9 @@ public:
     {
         Success = 999,
         Unknown,
-        ConstSignal
+        ConstSignal,
+        BufferOverflow,
+        NotEnoughData
     };
 
     struct CrossCorrelationResult
@@ -87,6 +144,10 @@ public:
                 return "Unknown error";
             case ConstSignal:
                 return "Cross Correlation of a const signal (silence)";
+            case BufferOverflow:
+                return "Too many values buffered";
+            case NotEnoughData:
+                return "Not enough correlated data";
             }
             /* Unreachable, prevents gcc to complain */
             return "Invalid error (Unreachable)";
@@ -96,7 +157,49 @@ public:
     /** The type of the method returns. */
     typedef utilities::result::Result<SignalProcStatus> Result;
 
+    /** Cross correlation peak interpolated between integer delays. */
+    struct SubSampleCorrelationResult
+    {
+        /** Peak of the correlation at integer delays. */
+        CrossCorrelationResult peak;
+        /** Delay of the interpolated peak, within peak.delay +/- 0.5. */
+        double delay;
+        /** Coefficient of the interpolated peak. */
+        double coefficient;
+        /** Opposite of the correlation second derivative at the peak relative
+         *  to the peak coefficient. The higher, the narrower and the less
+         *  ambiguous the peak. Negative if the peak is not a local maximum. */
+        double sharpness;
+    };
+
+    /** Linear variation of the delay between two signals. */
+    struct DriftResult
+    {
+        /** Delay at the first value of the signals. */
+        double delay;
+        /** Delay variation per value, which is the relative difference of
+         *  the sampling rates of the signals: 1e-6 is 1 ppm. */
+        double drift;
+        /** Number of windows the drift was estimated from. */
+        size_t windowNb;
+    };
+
+    /** Statistics of a signal. */
+    struct Statistics
+    {
+        double mean;
+        /** Sum of the squared deviations to the mean, @see variance. */
+        double variance;
+        T min;
+        T max;
+        /** Sum of the squared values. */
+        double energy;
+    };
+
     /** Normalized cross corelation.
+     *
+     *  The FFT based implementation is used when the delay window is large
+     *  enough for it to be faster than the direct one (@see isFftPreferred).
      *
      *  @return the normalized cross correlation between the 2 signals A and B.
      */
@@ -107,6 +210,198 @@ public:
                                   ssize_t minDelay = 0,
                                   ssize_t maxDelay = 500);
 
+    /** Normalized cross correlation of signals which may be channels of
+     *  interleaved multi-channel signals.
+     *
+     *  Contiguous signals are correlated by the pointer version. Others are
+     *  correlated in the frequency domain: gathering their values into the
+     *  transform buffers is the only pass over them, no deinterleaved copy is
+     *  needed. The coefficients match cross_correlate_fft ones.
+     *  @see cross_correlate for other parameters.
+     */
+    static Result cross_correlate(const StridedSignal<T> &signalA,
+                                  const StridedSignal<T> &signalB,
+                                  size_t valueNb,
+                                  CrossCorrelationResult &result,
+                                  ssize_t minDelay = 0,
+                                  ssize_t maxDelay = 500);
+
+    /** Normalized cross correlation of all the channel pairs of two
+     *  interleaved multi-channel signals.
+     *
+     *  Each signal is read once, frame by frame, every channel being gathered
+     *  into its own transform buffer. Each channel is transformed once, then
+     *  each pair only costs a spectrum product and an inverse transform.
+     *  Memory use is one spectrum of L values (@see cross_correlate_fft) per
+     *  channel, plus one for the pairs.
+     *
+     *  @param[in] framesA the frameNb frames of channelNbA interleaved values of signal A.
+     *  @param[in] framesB the frameNb frames of channelNbB interleaved values of signal B.
+     *  @param[out] results channelNbA * channelNbB results, results[a * channelNbB + b]
+     *                      being the correlation of the channel a of signal A with
+     *                      the channel b of signal B. Pairs with a constant channel
+     *                      have a null coefficient and the maximum delay value.
+     *  @return ConstSignal if a channel is constant, the other pairs being still
+     *          correlated.
+     *  @see cross_correlate for other parameters.
+     */
+    static Result cross_correlate_channels(const T *framesA,
+                                           size_t channelNbA,
+                                           const T *framesB,
+                                           size_t channelNbB,
+                                           size_t frameNb,
+                                           std::vector<CrossCorrelationResult> &results,
+                                           ssize_t minDelay = 0,
+                                           ssize_t maxDelay = 500);
+
+    /** Normalized cross correlation computed delay by delay.
+     *
+     *  Costs O(valueNb * (maxDelay - minDelay)).
+     *  @see cross_correlate for parameters.
+     */
+    static Result cross_correlate_direct(const T *signalA,
+                                         const T *signalB,
+                                         size_t valueNb,
+                                         CrossCorrelationResult &result,
+                                         ssize_t minDelay = 0,
+                                         ssize_t maxDelay = 500);
+
+    /** Normalized cross correlation computed for all delays at once in the
+     *  frequency domain.
+     *
+     *  Costs O(L * log(L)) where L is valueNb + max(|minDelay|, |maxDelay|)
+     *  rounded up to a power of two.
+     *  The coefficients differ from cross_correlate_direct ones by less than
+     *  1e-9 (rounding errors of the transform), thus the delays only differ
+     *  if two coefficients of the direct correlation are closer than that.
+     *  @see cross_correlate for parameters.
+     */
+    static Result cross_correlate_fft(const T *signalA,
+                                      const T *signalB,
+                                      size_t valueNb,
+                                      CrossCorrelationResult &result,
+                                      ssize_t minDelay = 0,
+                                      ssize_t maxDelay = 500);
+
+    /** Generalized cross correlation with phase transform (GCC-PHAT).
+     *
+     *  The cross spectrum of the signals is whitened: only its phase is kept.
+     *  Peaks are thus much sharper than the normalized correlation ones on
+     *  coloured or reverberant signals. Costs about as much as
+     *  cross_correlate_fft.
+     *  The coefficient is the value of the whitened correlation at the delay:
+     *  1 for a circular delay of white signals, lower as the signals differ.
+     *  @see cross_correlate for parameters.
+     */
+    static Result cross_correlate_phat(const T *signalA,
+                                       const T *signalB,
+                                       size_t valueNb,
+                                       CrossCorrelationResult &result,
+                                       ssize_t minDelay = 0,
+                                       ssize_t maxDelay = 500);
+
+    /** Normalized cross correlation computed delay by delay, the delay range
+     *  being split among several threads.
+     *
+     *  The result is exactly the same as cross_correlate_direct one: among
+     *  delays with the same coefficient, the smallest one is kept.
+     *  Threads are utilities::Thread, users must link with libaudio_utilities.
+     *
+     *  @param[in] threadNb number of threads sharing the delays, including
+     *                      the calling one. 0 is handled as 1.
+     *  @see cross_correlate for other parameters.
+     */
+    static Result cross_correlate_parallel(const T *signalA,
+                                           const T *signalB,
+                                           size_t valueNb,
+                                           CrossCorrelationResult &result,
+                                           ssize_t minDelay,
+                                           ssize_t maxDelay,
+                                           size_t threadNb);
+
+    /** Normalized cross correlation searched coarse to fine.
+     *
+     *  Both signals are low pass filtered and decimated, the correlation is
+     *  computed for all delays at the low rate, then the exact correlation is
+     *  only computed around the full rate delays of the candidateNb best low
+     *  rate local maxima (+/- decimation delays).
+     *  Costs about O(valueNb * ((maxDelay - minDelay) / decimation^2 +
+     *  candidateNb * decimation)).
+     *
+     *  The result is the one of cross_correlate_direct as long as its delay is
+     *  in one of the refined windows, which the returned candidates allow to
+     *  check. Among delays with the same coefficient, the smallest one is kept.
+     *
+     *  @param[in] decimation factor between the full and the low rate.
+     *                        Below 2, the search is not hierarchical.
+     *  @param[in] candidateNb number of low rate maxima to refine. If it is 0,
+     *                         or if the low rate grid has no delay, the search
+     *                         falls back to all the delays of [minDelay, maxDelay].
+     *  @param[out] candidates the low rate maxima which were refined, sorted by
+     *                         decreasing low rate coefficient. Their delays are
+     *                         given at the full rate.
+     *  @see cross_correlate for other parameters.
+     */
+    static Result cross_correlate_coarse_to_fine(const T *signalA,
+                                                 const T *signalB,
+                                                 size_t valueNb,
+                                                 CrossCorrelationResult &result,
+                                                 ssize_t minDelay,
+                                                 ssize_t maxDelay,
+                                                 size_t decimation,
+                                                 size_t candidateNb,
+                                                 std::vector<CrossCorrelationResult> &candidates);
+
+    /** Normalized cross correlation with a sub-sample delay.
+     *
+     *  The peak found by cross_correlate is refined by fitting a parabola on
+     *  the coefficients of its delay and its two neighbours.
+     *  If no delay is positively correlated, the peak is not interpolated.
+     *  @see cross_correlate for parameters.
+     */
+    static Result cross_correlate_subsample(const T *signalA,
+                                            const T *signalB,
+                                            size_t valueNb,
+                                            SubSampleCorrelationResult &result,
+                                            ssize_t minDelay = 0,
+                                            ssize_t maxDelay = 500);
+
+    /** Estimate the sampling rate drift between two signals.
+     *
+     *  The sub-sample delay of consecutive windows is computed with
+     *  cross_correlate_subsample, then a line is fitted (least squares) on
+     *  the delays of the window centers.
+     *  Constant windows and windows without positive correlation are ignored.
+     *
+     *  @param[in] windowSize number of values correlated by window.
+     *  @param[in] hopSize number of values between consecutive windows.
+     *  @return NotEnoughData if less than 2 windows could be correlated.
+     *  @see cross_correlate for other parameters.
+     */
+    static Result estimate_drift(const T *signalA,
+                                 const T *signalB,
+                                 size_t valueNb,
+                                 size_t windowSize,
+                                 size_t hopSize,
+                                 DriftResult &result,
+                                 ssize_t minDelay = 0,
+                                 ssize_t maxDelay = 500);
+
+    /** @return true if cross_correlate_fft is expected to be faster than
+     *          cross_correlate_direct for those parameters.
+     */
+    static bool isFftPreferred(size_t valueNb, ssize_t minDelay, ssize_t maxDelay);
+
+    /** Calculate all the statistics of a signal in a single pass over memory.
+     *
+     *  The signal is processed by blocks small enough to stay in cache, each
+     *  statistic of a block being computed while it is still cached.
+     *  Mean and variance are the same as the ones returned by mean and variance,
+     *  up to rounding errors for float signals.
+     *  The statistics of an empty signal are undefined.
+     */
+    static Statistics statistics(const T *signal, size_t valueNb);
+
     /** Calculate the mean (average) of a signal. */
     static double mean(const T *signal, size_t valueNb);
 
@@ -128,22 +423,195 @@ public:
         double meanA, double meanB,
         const T *signalA, const T *signalB,
         size_t valueNb, ssize_t offsetB);
+
+private:
+    /** What is needed to normalize the product of two signals. */
+    struct Normalization
+    {
+        double meanA;
+        double meanB;
+        /** sqrt(varianceA * varianceB) */
+        double denom;
+    };
+
+    /** Compute the normalization of the cross correlation of two signals.
+     *
+     *  @return ConstSignal if one of the signals is constant.
+     */
+    static Result normalize(const T *signalA, const T *signalB, size_t valueNb,
+                            Normalization &normalization);
+
+    /** Compute the correlation coefficient of each delay of [minDelay, maxDelay]
+     *  and keep the first greatest one in result.
+     */
+    static void searchDelays(const Normalization &normalization,
+                             const T *signalA, const T *signalB, size_t valueNb,
+                             ssize_t minDelay, ssize_t maxDelay,
+                             CrossCorrelationResult &result);
+
+    /** Same as searchDelays, in the frequency domain. */
+    static void searchDelaysFft(const Normalization &normalization,
+                                const T *signalA, const T *signalB, size_t valueNb,
+                                ssize_t minDelay, ssize_t maxDelay,
+                                CrossCorrelationResult &result);
+
+    /** Gather the channels of interleaved frames, centre and zero pad them up
+     *  to the transform size, then transform them in place.
+     *
+     *  @param[in] frames the frameNb frames, frameStride values apart.
+     *  @param[in] channelNb number of channels to gather, at the beginning of
+     *                       each frame.
+     *  @param[out] spectra the spectrum of each channel.
+     *  @param[out] variances the sum of squared deviations of each channel.
+     */
+    static void gatherSpectra(const RealFft &fft,
+                              const T *frames, size_t frameStride,
+                              size_t channelNb, size_t frameNb,
+                              std::vector<std::vector<RealFft::Complex> > &spectra,
+                              std::vector<double> &variances);
+
+    /** Weighting of the cross spectrum of two signals. */
+    enum CrossSpectrumWeighting
+    {
+        NoWeighting,
+        /** Keep only the phase of the cross spectrum (GCC-PHAT). */
+        PhaseTransform
+    };
+
+    /** Correlate two centred spectra and keep the first greatest coefficient
+     *  of [minDelay, maxDelay], which must be within ]-L, L[.
+     *
+     *  @param[out] work getSpectrumSize() bins of working memory.
+     */
+    static void searchSpectra(const RealFft &fft,
+                              const RealFft::Complex *spectrumA,
+                              const RealFft::Complex *spectrumB,
+                              double denom,
+                              ssize_t minDelay, ssize_t maxDelay,
+                              RealFft::Complex *work,
+                              CrossCorrelationResult &result,
+                              CrossSpectrumWeighting weighting = NoWeighting);
+
+    /** Correlate two signals in the frequency domain, without allocating.
+     *
+     *  @param[in] fft transform of getCorrelationFftSize() values.
+     *  @param[in] minDelay, maxDelay delay range, clamped by clampDelays.
+     *  @param[out] spectrumA, spectrumB getSpectrumSize() bins of working memory.
+     */
+    static void correlateSpectra(const RealFft &fft, const Normalization &normalization,
+                                 const T *signalA, const T *signalB, size_t valueNb,
+                                 ssize_t minDelay, ssize_t maxDelay,
+                                 RealFft::Complex *spectrumA, RealFft::Complex *spectrumB,
+                                 CrossCorrelationResult &result,
+                                 CrossSpectrumWeighting weighting);
+
+    /** Centre a signal, zero pad it up to the transform size and transform it
+     *  in place.
+     *
+     *  @param[out] spectrum getSpectrumSize() bins.
+     */
+    static void transformCentred(const RealFft &fft, const T *signal, size_t valueNb,
+                                 double mean, RealFft::Complex *spectrum);
+
+    /** Restrict a delay range to ]-valueNb, valueNb[, where signals of
+     *  valueNb values overlap.
+     *
+     *  @return false if the signals do not overlap in the range.
+     */
+    static bool clampDelays(size_t valueNb, ssize_t &minDelay, ssize_t &maxDelay);
+
+    /** @return the size of the transforms correlating signals of valueNb values
+     *          over [minDelay, maxDelay] without wrapping around.
+     */
+    static size_t getCorrelationFftSize(size_t valueNb, ssize_t minDelay, ssize_t maxDelay);
+
+    /** Low pass filter (windowed sinc) then decimate a centred signal.
+     *
+     *  @param[out] decimated the decimated signal: valueNb / decimation values.
+     */
+    static void decimate(const T *signal, size_t valueNb, double mean, size_t decimation,
+                         std::vector<double> &decimated);
+
+    /** @return the floor of numerator / denominator, for a positive denominator. */
+    static ssize_t floorDivide(ssize_t numerator, size_t denominator);
+
+    /** Thread searching the best coefficient of a delay range. */
+    class DelaySearchThread : public Thread
+    {
+    public:
+        DelaySearchThread(const Normalization &normalization,
+                          const T *signalA, const T *signalB, size_t valueNb,
+                          ssize_t minDelay, ssize_t maxDelay)
+            : Thread("CrossCorrelate"), mNormalization(normalization),
+              mSignalA(signalA), mSignalB(signalB), mValueNb(valueNb),
+              mMinDelay(minDelay), mMaxDelay(maxDelay)
+        {}
+
+        /** Search the delay range in the calling thread. */
+        void search()
+        {
+            searchDelays(mNormalization, mSignalA, mSignalB, mValueNb,
+                         mMinDelay, mMaxDelay, mResult);
+        }
+
+        const CrossCorrelationResult &getResult() const { return mResult; }
+
+    private:
+        virtual void processing()
+        {
+            search();
+            selfAbort();
+        }
+
+        const Normalization &mNormalization;
+        const T *mSignalA;
+        const T *mSignalB;
+        size_t mValueNb;
+        ssize_t mMinDelay;
+        ssize_t mMaxDelay;
+        CrossCorrelationResult mResult;
+    };
 };
 
 
 template <class T>
-double SignalProcessing<T>::mean(const T *signal, size_t valueNb)
+typename SignalProcessing<T>::Statistics SignalProcessing<T>::statistics(const T *signal,
+                                                                         size_t valueNb)
 {
     /* Check that processing with that type is allowed.
      * If this fails, this means that this template was not intended to be used
      * with this type, thus that the result is undefined. */
     details::ProcessingAllowed<T>();
 
-    double sum = 0;
-    for (size_t i = 0; i < valueNb; i++) {
-        sum += signal[i];
+    /** 16kB of 32 bits samples, fits in any L1 data cache. */
+    const size_t blockSize = 4096;
+
+    Statistics statistics;
+    statistics.min = std::numeric_limits<T>::max();
+    statistics.max = details::lowest<T>();
+
+    details::MomentsAccumulator<T> moments;
+    for (size_t start = 0; start < valueNb; start += blockSize) {
+        size_t blockValueNb = std::min(blockSize, valueNb - start);
+        details::minMax(signal + start, blockValueNb, statistics.min, statistics.max);
+        moments.add(signal + start, blockValueNb);
     }
-    return sum / valueNb;
+
+    statistics.mean = moments.mean();
+    statistics.variance = moments.centredSquares();
+    statistics.energy = moments.energy();
+    return statistics;
+}
+
+template <class T>
+double SignalProcessing<T>::mean(const T *signal, size_t valueNb)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    return double(details::sum(signal, valueNb)) / valueNb;
 }
 
 template <class T>
@@ -154,11 +622,7 @@ double SignalProcessing<T>::variance(double mean, const T *signal, size_t valueN
      * with this type, thus that the result is undefined. */
     details::ProcessingAllowed<T>();
 
-    double variance = 0;
-    for (size_t i = 0; i < valueNb; i++) {
-        variance += pow(signal[i] - mean, 2);
-    }
-    return variance;
+    return details::Moments<T>::centredSquares(mean, signal, valueNb);
 }
 
 template <class T>
@@ -171,15 +635,39 @@ double SignalProcessing<T>::normalizedOffsetProduct(double meanA, double meanB,
      * with this type, thus that the result is undefined. */
     details::ProcessingAllowed<T>();
 
+    if (std::abs(offsetB) >= static_cast<ssize_t>(valueNb)) {
+        // Signals do not overlap
+        return 0;
+    }
     size_t startIndexA = std::max<ssize_t>(0, offsetB);
     size_t stopIndexA = valueNb + std::min<ssize_t>(0, offsetB);
 
-    double normProd = 0;
-    for (size_t indexA = startIndexA; indexA < stopIndexA; indexA++) {
-        size_t indexB = indexA - offsetB;
-        normProd += (signalA[indexA] - meanA) * (signalB[indexB] - meanB);
+    return details::Moments<T>::centredProducts(meanA, meanB,
+                                                signalA + startIndexA,
+                                                signalB + startIndexA - offsetB,
+                                                stopIndexA - startIndexA);
+}
+
+template <class T>
+bool SignalProcessing<T>::isFftPreferred(size_t valueNb, ssize_t minDelay, ssize_t maxDelay)
+{
+    /** Under this number of delays, the direct implementation is always faster. */
+    const ssize_t minFftDelayNb = 32;
+    /** Rough cost of a transform butterfly compared to a multiply-accumulate. */
+    const size_t butterflyCost = 8;
+
+    if (maxDelay - minDelay + 1 < minFftDelayNb) {
+        return false;
     }
-    return normProd;
+    size_t delayNb = maxDelay - minDelay + 1;
+    size_t fftSize = getCorrelationFftSize(valueNb, minDelay, maxDelay);
+    size_t log2FftSize = 0;
+    while ((size_t(1) << log2FftSize) < fftSize) {
+        log2FftSize++;
+    }
+
+    // 3 transforms of size fftSize against one product per overlapping value and delay.
+    return delayNb * valueNb > 3 * butterflyCost * fftSize * log2FftSize;
 }
 
 template <class T>
@@ -190,45 +678,720 @@ typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate(
     CrossCorrelationResult &result,
     ssize_t minDelay,
     ssize_t maxDelay)
+{
+    if (isFftPreferred(valueNb, minDelay, maxDelay)) {
+        return cross_correlate_fft(signalA, signalB, valueNb, result, minDelay, maxDelay);
+    }
+    return cross_correlate_direct(signalA, signalB, valueNb, result, minDelay, maxDelay);
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_direct(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    CrossCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay)
 {
     /* Check that processing with that type is allowed.
      * If this fails, this means that this template was not intended to be used
      * with this type, thus that the result is undefined. */
     details::ProcessingAllowed<T>();
 
-    double meanA = mean(signalA, valueNb);
-    double meanB = mean(signalB, valueNb);
+    Normalization normalization;
+    Result status = normalize(signalA, signalB, valueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+
+    searchDelays(normalization, signalA, signalB, valueNb, minDelay, maxDelay, result);
 
-    double varianceA = variance(meanA, signalA, valueNb);
-    double varianceB = variance(meanB, signalB, valueNb);
+    return Result::success();
 
-    double denom = sqrt(varianceA * varianceB);
+}
 
-    if (denom == 0) {
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_parallel(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    CrossCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay,
+    size_t threadNb)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    Normalization normalization;
+    Result status = normalize(signalA, signalB, valueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+
+    size_t delayNb = minDelay <= maxDelay ? maxDelay - minDelay + 1 : 0;
+    size_t chunkNb = std::max<size_t>(1, std::min(threadNb, delayNb));
+
+    // Chunk 0 is searched by the calling thread, the others by worker threads.
+    std::vector<DelaySearchThread *> threads;
+    for (size_t chunk = 1; chunk < chunkNb; chunk++) {
+        ssize_t chunkMinDelay = minDelay + delayNb * chunk / chunkNb;
+        ssize_t chunkMaxDelay = minDelay + delayNb * (chunk + 1) / chunkNb - 1;
+        threads.push_back(new DelaySearchThread(normalization, signalA, signalB, valueNb,
+                                                chunkMinDelay, chunkMaxDelay));
+    }
+
+    std::vector<bool> started(threads.size());
+    for (size_t i = 0; i < threads.size(); i++) {
+        started[i] = threads[i]->start();
+    }
+
+    searchDelays(normalization, signalA, signalB, valueNb,
+                 minDelay, minDelay + delayNb / chunkNb - 1, result);
+
+    // Merge in increasing delay order, keeping the first greatest coefficient
+    // as the sequential search does.
+    for (size_t i = 0; i < threads.size(); i++) {
+        if (started[i]) {
+            threads[i]->stop();
+        } else {
+            // Thread creation failed, do its job here
+            threads[i]->search();
+        }
+        const CrossCorrelationResult &chunkResult = threads[i]->getResult();
+        if (chunkResult.coefficient > result.coefficient) {
+            result = chunkResult;
+        }
+        delete threads[i];
+    }
+
+    return Result::success();
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_coarse_to_fine(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    CrossCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay,
+    size_t decimation,
+    size_t candidateNb,
+    std::vector<CrossCorrelationResult> &candidates)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    candidates.clear();
+
+    Normalization normalization;
+    Result status = normalize(signalA, signalB, valueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+
+    if (decimation < 2 || valueNb / decimation < 2) {
+        searchDelays(normalization, signalA, signalB, valueNb, minDelay, maxDelay, result);
+        return Result::success();
+    }
+
+    std::vector<double> decimatedA;
+    std::vector<double> decimatedB;
+    decimate(signalA, valueNb, normalization.meanA, decimation, decimatedA);
+    decimate(signalB, valueNb, normalization.meanB, decimation, decimatedB);
+
+    ssize_t decimatedNb = decimatedA.size();
+    double energyA = 0;
+    double energyB = 0;
+    for (ssize_t i = 0; i < decimatedNb; i++) {
+        energyA += decimatedA[i] * decimatedA[i];
+        energyB += decimatedB[i] * decimatedB[i];
+    }
+    double decimatedDenom = sqrt(energyA * energyB);
+
+    // Low rate correlation of all the delays, the grid enclosing [minDelay, maxDelay]
+    ssize_t minCoarseDelay = std::max(floorDivide(minDelay, decimation), 1 - decimatedNb);
+    ssize_t maxCoarseDelay = std::min(-floorDivide(-maxDelay, decimation), decimatedNb - 1);
+    std::vector<double> coefficients;
+    for (ssize_t delay = minCoarseDelay; delay <= maxCoarseDelay; delay++) {
+        double product = 0;
+        for (ssize_t indexA = std::max<ssize_t>(0, -delay);
+             indexA < std::min(decimatedNb, decimatedNb - delay); indexA++) {
+            product += decimatedA[indexA] * decimatedB[indexA + delay];
+        }
+        coefficients.push_back(decimatedDenom == 0 ? 0 : product / decimatedDenom);
+    }
+
+    // Keep the best local maxima
+    for (size_t i = 0; i < coefficients.size(); i++) {
+        if ((i > 0 && coefficients[i - 1] > coefficients[i]) ||
+            (i + 1 < coefficients.size() && coefficients[i + 1] > coefficients[i])) {
+            continue;
+        }
+        CrossCorrelationResult candidate;
+        candidate.coefficient = coefficients[i];
+        candidate.delay = (minCoarseDelay + static_cast<ssize_t>(i)) * decimation;
+
+        // Insertion sort by decreasing coefficient, first found first on equality
+        typename std::vector<CrossCorrelationResult>::iterator position = candidates.begin();
+        while (position != candidates.end() && position->coefficient >= candidate.coefficient) {
+            ++position;
+        }
+        candidates.insert(position, candidate);
+        if (candidates.size() > candidateNb) {
+            candidates.pop_back();
+        }
+    }
+
+    if (candidates.empty()) {
+        // Delay range out of the low rate grid, or no candidate asked: nothing to refine
+        searchDelays(normalization, signalA, signalB, valueNb, minDelay, maxDelay, result);
+        return Result::success();
+    }
+
+    // Exact correlation around each candidate
+    result.coefficient = 0;
+    result.delay = std::numeric_limits<ssize_t>::max();
+    const ssize_t radius = decimation;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        CrossCorrelationResult refined;
+        searchDelays(normalization, signalA, signalB, valueNb,
+                     std::max(minDelay, candidates[i].delay - radius),
+                     std::min(maxDelay, candidates[i].delay + radius),
+                     refined);
+        if (refined.coefficient > result.coefficient ||
+            (refined.coefficient == result.coefficient && refined.delay < result.delay)) {
+            result = refined;
+        }
+    }
+
+    return Result::success();
+}
+
+template <class T>
+void SignalProcessing<T>::decimate(const T *signal, size_t valueNb, double mean,
+                                   size_t decimation, std::vector<double> &decimated)
+{
+    // Hamming windowed sinc, cut at the low rate Nyquist frequency
+    const ssize_t halfLength = 2 * decimation;
+    std::vector<double> taps(2 * halfLength + 1);
+    for (ssize_t j = -halfLength; j <= halfLength; j++) {
+        double sinc = j == 0 ? 1.0 / decimation : sin(M_PI * j / decimation) / (M_PI * j);
+        double window = 0.54 + 0.46 * cos(M_PI * j / halfLength);
+        taps[j + halfLength] = sinc * window;
+    }
+
+    decimated.resize(valueNb / decimation);
+    for (size_t k = 0; k < decimated.size(); k++) {
+        ssize_t center = k * decimation;
+        ssize_t first = std::max<ssize_t>(0, center - halfLength);
+        ssize_t last = std::min<ssize_t>(valueNb - 1, center + halfLength);
+        double value = 0;
+        for (ssize_t index = first; index <= last; index++) {
+            value += taps[index - center + halfLength] * (signal[index] - mean);
+        }
+        decimated[k] = value;
+    }
+}
+
+template <class T>
+ssize_t SignalProcessing<T>::floorDivide(ssize_t numerator, size_t denominator)
+{
+    ssize_t quotient = numerator / static_cast<ssize_t>(denominator);
+    if (numerator % static_cast<ssize_t>(denominator) < 0) {
+        quotient--;
+    }
+    return quotient;
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_subsample(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    SubSampleCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    // Normalized once, for both the peak search and its interpolation
+    Normalization normalization;
+    Result status = normalize(signalA, signalB, valueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+    if (isFftPreferred(valueNb, minDelay, maxDelay)) {
+        searchDelaysFft(normalization, signalA, signalB, valueNb, minDelay, maxDelay,
+                        result.peak);
+    } else {
+        searchDelays(normalization, signalA, signalB, valueNb, minDelay, maxDelay, result.peak);
+    }
+
+    result.delay = result.peak.delay;
+    result.coefficient = result.peak.coefficient;
+    result.sharpness = 0;
+    if (result.peak.delay == std::numeric_limits<ssize_t>::max()) {
+        // No positively correlated delay
+        return Result::success();
+    }
+
+    // Neighbours may be out of [minDelay, maxDelay], they are only used to interpolate.
+    // Coefficients are computed on the overlap of the signals only, which biases them
+    // towards the null delay: unbias them before interpolating.
+    double coefficients[3];
+    for (ssize_t i = 0; i < 3; i++) {
+        ssize_t delay = result.peak.delay + i - 1;
+        size_t overlap = valueNb - std::min<size_t>(std::labs(delay), valueNb - 1);
+        coefficients[i] = normalizedOffsetProduct(normalization.meanA, normalization.meanB,
+                                                  signalA, signalB, valueNb, -delay)
+                          / normalization.denom * valueNb / overlap;
+    }
+    double previous = coefficients[0];
+    double peak = coefficients[1];
+    double next = coefficients[2];
+
+    // Parabola through (-1, previous), (0, peak), (1, next)
+    double curvature = previous - 2 * peak + next;
+    result.sharpness = -curvature / peak;
+    if (curvature >= 0) {
+        // Not a local maximum (edge of the delay range), nothing to interpolate
+        return Result::success();
+    }
+    double offset = 0.5 * (previous - next) / curvature;
+    offset = std::max(-0.5, std::min(0.5, offset));
+
+    result.delay = result.peak.delay + offset;
+    result.coefficient = (peak - 0.25 * (previous - next) * offset)
+                         * (valueNb - std::fabs(result.delay)) / valueNb;
+
+    return Result::success();
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::estimate_drift(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    size_t windowSize,
+    size_t hopSize,
+    DriftResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    AUDIOUTILITIES_ASSERT(hopSize > 0, "Drift estimation hop size must not be null");
+
+    // Least squares fit of delay = result.delay + result.drift * time
+    double sumTime = 0;
+    double sumDelay = 0;
+    double sumTimeTime = 0;
+    double sumTimeDelay = 0;
+    result.windowNb = 0;
+
+    for (size_t start = 0; start + windowSize <= valueNb; start += hopSize) {
+        SubSampleCorrelationResult window;
+        Result status = cross_correlate_subsample(signalA + start, signalB + start, windowSize,
+                                                  window, minDelay, maxDelay);
+        if (status.isFailure() || window.peak.delay == std::numeric_limits<ssize_t>::max()) {
+            continue;
+        }
+        double time = start + windowSize / 2.0;
+        sumTime += time;
+        sumDelay += window.delay;
+        sumTimeTime += time * time;
+        sumTimeDelay += time * window.delay;
+        result.windowNb++;
+    }
+
+    if (result.windowNb < 2) {
+        return Result(NotEnoughData) << result.windowNb << " correlated windows";
+    }
+
+    double n = result.windowNb;
+    double timeVariance = sumTimeTime - sumTime * sumTime / n;
+    result.drift = (sumTimeDelay - sumTime * sumDelay / n) / timeVariance;
+    result.delay = (sumDelay - result.drift * sumTime) / n;
+
+    return Result::success();
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::normalize(
+    const T *signalA, const T *signalB, size_t valueNb, Normalization &normalization)
+{
+    Statistics statisticsA = statistics(signalA, valueNb);
+    Statistics statisticsB = statistics(signalB, valueNb);
+    normalization.meanA = statisticsA.mean;
+    normalization.meanB = statisticsB.mean;
+
+    normalization.denom = sqrt(statisticsA.variance * statisticsB.variance);
+
+    if (normalization.denom == 0) {
         /** if denom is 0, the cross correlation can't work because at least one
          *  signal is constant, so the variance is zero
          */
         return Result(ConstSignal);
     }
+    return Result::success();
+}
 
+template <class T>
+void SignalProcessing<T>::searchDelays(const Normalization &normalization,
+                                       const T *signalA, const T *signalB, size_t valueNb,
+                                       ssize_t minDelay, ssize_t maxDelay,
+                                       CrossCorrelationResult &result)
+{
     result.coefficient = 0;
     // Will be overwriten as for any x, x > maxCorrelationCoef (result.coefficient)
     result.delay = std::numeric_limits<ssize_t>::max();
 
     for (ssize_t delay = minDelay; delay <= maxDelay; delay++) {
-        double correlationCoef = normalizedOffsetProduct(meanA, meanB,
+        double correlationCoef = normalizedOffsetProduct(normalization.meanA,
+                                                         normalization.meanB,
                                                          signalA, signalB,
                                                          valueNb, -delay);
-        correlationCoef /= denom;
+        correlationCoef /= normalization.denom;
 
         if (correlationCoef > result.coefficient) {
             result.coefficient = correlationCoef;
             result.delay = delay;
         }
     }
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_fft(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    CrossCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    Normalization normalization;
+    Result status = normalize(signalA, signalB, valueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+
+    searchDelaysFft(normalization, signalA, signalB, valueNb, minDelay, maxDelay, result);
+
+    return Result::success();
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate(
+    const StridedSignal<T> &signalA,
+    const StridedSignal<T> &signalB,
+    size_t valueNb,
+    CrossCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    if (signalA.isContiguous() && signalB.isContiguous()) {
+        return cross_correlate(signalA.getFirst(), signalB.getFirst(), valueNb, result,
+                               minDelay, maxDelay);
+    }
+
+    result.coefficient = 0;
+    // Will be overwriten as for any x, x > maxCorrelationCoef (result.coefficient)
+    result.delay = std::numeric_limits<ssize_t>::max();
+
+    bool overlap = clampDelays(valueNb, minDelay, maxDelay);
+    RealFft fft(getCorrelationFftSize(valueNb, minDelay, maxDelay));
+
+    std::vector<std::vector<RealFft::Complex> > spectraA;
+    std::vector<std::vector<RealFft::Complex> > spectraB;
+    std::vector<double> variancesA;
+    std::vector<double> variancesB;
+    gatherSpectra(fft, signalA.getFirst(), signalA.getStride(), 1, valueNb,
+                  spectraA, variancesA);
+    gatherSpectra(fft, signalB.getFirst(), signalB.getStride(), 1, valueNb,
+                  spectraB, variancesB);
+
+    double denom = sqrt(variancesA[0] * variancesB[0]);
+    if (denom == 0) {
+        return Result(ConstSignal);
+    }
+
+    if (overlap) {
+        searchSpectra(fft, &spectraA[0][0], &spectraB[0][0], denom, minDelay, maxDelay,
+                      &spectraA[0][0], result);
+    }
+
+    return Result::success();
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_phat(
+    const T *signalA,
+    const T *signalB,
+    size_t valueNb,
+    CrossCorrelationResult &result,
+    ssize_t minDelay,
+    ssize_t maxDelay)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    Normalization normalization;
+    Result status = normalize(signalA, signalB, valueNb, normalization);
+    if (status.isFailure()) {
+        return status;
+    }
+    result.coefficient = 0;
+    // Will be overwriten as for any x, x > maxCorrelationCoef (result.coefficient)
+    result.delay = std::numeric_limits<ssize_t>::max();
+
+    if (not clampDelays(valueNb, minDelay, maxDelay)) {
+        return Result::success();
+    }
+    RealFft fft(getCorrelationFftSize(valueNb, minDelay, maxDelay));
+    std::vector<RealFft::Complex> spectrumA(fft.getSpectrumSize());
+    std::vector<RealFft::Complex> spectrumB(fft.getSpectrumSize());
+
+    correlateSpectra(fft, normalization, signalA, signalB, valueNb, minDelay, maxDelay,
+                     &spectrumA[0], &spectrumB[0], result, PhaseTransform);
 
     return Result::success();
+}
+
+template <class T>
+typename SignalProcessing<T>::Result SignalProcessing<T>::cross_correlate_channels(
+    const T *framesA,
+    size_t channelNbA,
+    const T *framesB,
+    size_t channelNbB,
+    size_t frameNb,
+    std::vector<CrossCorrelationResult> &results,
+    ssize_t minDelay,
+    ssize_t maxDelay)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    CrossCorrelationResult uncorrelated;
+    uncorrelated.coefficient = 0;
+    uncorrelated.delay = std::numeric_limits<ssize_t>::max();
+    results.assign(channelNbA * channelNbB, uncorrelated);
+
+    bool overlap = clampDelays(frameNb, minDelay, maxDelay);
+    RealFft fft(getCorrelationFftSize(frameNb, minDelay, maxDelay));
+
+    std::vector<std::vector<RealFft::Complex> > spectraA;
+    std::vector<std::vector<RealFft::Complex> > spectraB;
+    std::vector<double> variancesA;
+    std::vector<double> variancesB;
+    gatherSpectra(fft, framesA, channelNbA, channelNbA, frameNb, spectraA, variancesA);
+    gatherSpectra(fft, framesB, channelNbB, channelNbB, frameNb, spectraB, variancesB);
+
+    Result status = Result::success();
+    for (size_t a = 0; a < channelNbA; a++) {
+        if (variancesA[a] == 0) {
+            status = Result(ConstSignal) << "channel " << a << " of signal A";
+        }
+    }
+    for (size_t b = 0; b < channelNbB; b++) {
+        if (variancesB[b] == 0) {
+            status = Result(ConstSignal) << "channel " << b << " of signal B";
+        }
+    }
+
+    if (not overlap) {
+        return status;
+    }
+
+    std::vector<RealFft::Complex> work(fft.getSpectrumSize());
+    for (size_t a = 0; a < channelNbA; a++) {
+        for (size_t b = 0; b < channelNbB; b++) {
+            double denom = sqrt(variancesA[a] * variancesB[b]);
+            if (denom != 0) {
+                searchSpectra(fft, &spectraA[a][0], &spectraB[b][0], denom,
+                              minDelay, maxDelay, &work[0], results[a * channelNbB + b]);
+            }
+        }
+    }
+
+    return status;
+}
+
+template <class T>
+void SignalProcessing<T>::gatherSpectra(const RealFft &fft,
+                                        const T *frames, size_t frameStride,
+                                        size_t channelNb, size_t frameNb,
+                                        std::vector<std::vector<RealFft::Complex> > &spectra,
+                                        std::vector<double> &variances)
+{
+    spectra.assign(channelNb, std::vector<RealFft::Complex>(fft.getSpectrumSize()));
+    variances.assign(channelNb, 0);
 
+    // The spectra buffers hold the samples until they are transformed in place.
+    std::vector<double *> samples(channelNb);
+    std::vector<double> sums(channelNb, 0);
+    for (size_t channel = 0; channel < channelNb; channel++) {
+        samples[channel] = reinterpret_cast<double *>(&spectra[channel][0]);
+    }
+
+    // Single pass over the frames
+    for (size_t i = 0; i < frameNb; i++) {
+        const T *frame = frames + i * frameStride;
+        for (size_t channel = 0; channel < channelNb; channel++) {
+            samples[channel][i] = frame[channel];
+            sums[channel] += frame[channel];
+        }
+    }
+
+    for (size_t channel = 0; channel < channelNb; channel++) {
+        double *channelSamples = samples[channel];
+        double mean = sums[channel] / frameNb;
+        double variance = 0;
+        for (size_t i = 0; i < frameNb; i++) {
+            channelSamples[i] -= mean;
+            variance += channelSamples[i] * channelSamples[i];
+        }
+        std::fill(channelSamples + frameNb, channelSamples + fft.getSize(), 0.0);
+        variances[channel] = variance;
+
+        fft.forward(channelSamples, &spectra[channel][0]);
+    }
+}
+
+template <class T>
+void SignalProcessing<T>::searchSpectra(const RealFft &fft,
+                                        const RealFft::Complex *spectrumA,
+                                        const RealFft::Complex *spectrumB,
+                                        double denom,
+                                        ssize_t minDelay, ssize_t maxDelay,
+                                        RealFft::Complex *work,
+                                        CrossCorrelationResult &result,
+                                        CrossSpectrumWeighting weighting)
+{
+    result.coefficient = 0;
+    // Will be overwriten as for any x, x > maxCorrelationCoef (result.coefficient)
+    result.delay = std::numeric_limits<ssize_t>::max();
+
+    // conj(A) * B is the spectrum of sum(A(t) * B(t + delay))
+    for (size_t k = 0; k < fft.getSpectrumSize(); k++) {
+        work[k] = std::conj(spectrumA[k]) * spectrumB[k];
+    }
+    if (weighting == PhaseTransform) {
+        for (size_t k = 0; k < fft.getSpectrumSize(); k++) {
+            double magnitude = std::abs(work[k]);
+            work[k] = magnitude > 0 ? work[k] / magnitude : 0;
+        }
+    }
+    double *correlation = reinterpret_cast<double *>(work);
+    fft.inverse(work, correlation);
+
+    size_t fftSize = fft.getSize();
+    for (ssize_t delay = minDelay; delay <= maxDelay; delay++) {
+        size_t index = delay >= 0 ? delay : fftSize + delay;
+        double correlationCoef = correlation[index] / denom;
+
+        if (correlationCoef > result.coefficient) {
+            result.coefficient = correlationCoef;
+            result.delay = delay;
+        }
+    }
+}
+
+template <class T>
+void SignalProcessing<T>::searchDelaysFft(const Normalization &normalization,
+                                          const T *signalA, const T *signalB, size_t valueNb,
+                                          ssize_t minDelay, ssize_t maxDelay,
+                                          CrossCorrelationResult &result)
+{
+    result.coefficient = 0;
+    // Will be overwriten as for any x, x > maxCorrelationCoef (result.coefficient)
+    result.delay = std::numeric_limits<ssize_t>::max();
+
+    if (not clampDelays(valueNb, minDelay, maxDelay)) {
+        return;
+    }
+    RealFft fft(getCorrelationFftSize(valueNb, minDelay, maxDelay));
+    std::vector<RealFft::Complex> spectrumA(fft.getSpectrumSize());
+    std::vector<RealFft::Complex> spectrumB(fft.getSpectrumSize());
+
+    correlateSpectra(fft, normalization, signalA, signalB, valueNb, minDelay, maxDelay,
+                     &spectrumA[0], &spectrumB[0], result, NoWeighting);
+}
+
+template <class T>
+void SignalProcessing<T>::correlateSpectra(const RealFft &fft, const Normalization &normalization,
+                                           const T *signalA, const T *signalB, size_t valueNb,
+                                           ssize_t minDelay, ssize_t maxDelay,
+                                           RealFft::Complex *spectrumA,
+                                           RealFft::Complex *spectrumB,
+                                           CrossCorrelationResult &result,
+                                           CrossSpectrumWeighting weighting)
+{
+    transformCentred(fft, signalA, valueNb, normalization.meanA, spectrumA);
+    transformCentred(fft, signalB, valueNb, normalization.meanB, spectrumB);
+
+    // The phase transform correlation is already normalized
+    double denom = weighting == PhaseTransform ? 1 : normalization.denom;
+    searchSpectra(fft, spectrumA, spectrumB, denom, minDelay, maxDelay,
+                  spectrumA, result, weighting);
+}
+
+template <class T>
+void SignalProcessing<T>::transformCentred(const RealFft &fft, const T *signal, size_t valueNb,
+                                           double mean, RealFft::Complex *spectrum)
+{
+    // The spectrum holds the samples until they are transformed in place.
+    double *samples = reinterpret_cast<double *>(spectrum);
+    for (size_t i = 0; i < valueNb; i++) {
+        samples[i] = signal[i] - mean;
+    }
+    std::fill(samples + valueNb, samples + fft.getSize(), 0.0);
+    fft.forward(samples, spectrum);
+}
+
+template <class T>
+bool SignalProcessing<T>::clampDelays(size_t valueNb, ssize_t &minDelay, ssize_t &maxDelay)
+{
+    // Signals do not overlap for delays out of ]-valueNb, valueNb[, their product is null.
+    minDelay = std::max<ssize_t>(minDelay, 1 - static_cast<ssize_t>(valueNb));
+    maxDelay = std::min<ssize_t>(maxDelay, static_cast<ssize_t>(valueNb) - 1);
+    return minDelay <= maxDelay;
+}
+
+template <class T>
+size_t SignalProcessing<T>::getCorrelationFftSize(size_t valueNb,
+                                                  ssize_t minDelay, ssize_t maxDelay)
+{
+    // Zero padding up to the transform size prevents the circular correlation
+    // from wrapping around within [minDelay, maxDelay].
+    size_t maxAbsDelay = std::max(std::abs(minDelay), std::abs(maxDelay));
+    return RealFft::nextPowerOfTwo(valueNb + std::min(maxAbsDelay, valueNb));
 }
 
 }
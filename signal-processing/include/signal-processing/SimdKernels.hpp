@@ -0,0 +1,1406 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIOUTILITIES_SIMD_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIOUTILITIES_SIMD_NEON 1
+#endif
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+namespace details
+{
+
+/** Instruction sets the signal processing kernels are implemented with. */
+enum SimdLevel
+{
+    SimdScalar,
+    SimdSse2,
+    SimdAvx2,
+    SimdNeon
+};
+
+/** @return the name of a level, for reports. */
+inline const char *getSimdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdScalar:
+        return "scalar";
+    case SimdSse2:
+        return "sse2";
+    case SimdAvx2:
+        return "avx2";
+    case SimdNeon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+/** @return the most efficient instruction set supported by the running cpu. */
+inline SimdLevel detectSimdLevel()
+{
+#if defined(AUDIOUTILITIES_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdSse2;
+    }
+#elif defined(AUDIOUTILITIES_SIMD_NEON)
+    return SimdNeon;
+#endif
+    return SimdScalar;
+}
+
+/** @return true if the running cpu can execute the kernels of a given level. */
+inline bool isSimdLevelSupported(SimdLevel level)
+{
+    SimdLevel detected = detectSimdLevel();
+    switch (level) {
+    case SimdScalar:
+        return true;
+    case SimdSse2:
+        // AVX2 cpus also execute SSE2
+        return detected == SimdSse2 || detected == SimdAvx2;
+    case SimdAvx2:
+    case SimdNeon:
+        return detected == level;
+    }
+    return false;
+}
+
+/** Kernels level currently used, detected at first use. */
+inline SimdLevel &currentSimdLevel()
+{
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+/** @return the level of the kernels used by the signal processing functions. */
+inline SimdLevel getSimdLevel()
+{
+    return currentSimdLevel();
+}
+
+/** Force the level of the kernels used, mostly to compare them in tests.
+ *
+ *  Not thread safe: must not be called while signals are being processed.
+ *  @return false if the cpu does not support this level, which is not applied.
+ */
+inline bool setSimdLevel(SimdLevel level)
+{
+    if (not isSimdLevelSupported(level)) {
+        return false;
+    }
+    currentSimdLevel() = level;
+    return true;
+}
+
+/** Portable implementation of the kernels.
+ *
+ *  Sums of 8 and 16 bits samples are computed exactly with 64 bits integers.
+ *  32 bits and float samples squares do not fit in 64 bits integers, they are
+ *  computed centred, in double.
+ */
+namespace scalar
+{
+
+template <class T>
+inline int64_t sum(const T *signal, size_t valueNb)
+{
+    int64_t sum = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        sum += signal[i];
+    }
+    return sum;
+}
+
+inline double sum(const float *signal, size_t valueNb)
+{
+    double sum = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        sum += signal[i];
+    }
+    return sum;
+}
+
+template <class T>
+inline int64_t sumOfSquares(const T *signal, size_t valueNb)
+{
+    int64_t sum = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        sum += int32_t(signal[i]) * signal[i];
+    }
+    return sum;
+}
+
+template <class T>
+inline void productSums(const T *signalA, const T *signalB, size_t valueNb,
+                        int64_t &sumA, int64_t &sumB, int64_t &sumAB)
+{
+    sumA = sumB = sumAB = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        sumA += signalA[i];
+        sumB += signalB[i];
+        sumAB += int32_t(signalA[i]) * signalB[i];
+    }
+}
+
+template <class T>
+inline double centredSumOfSquares(double mean, const T *signal, size_t valueNb)
+{
+    double sum = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        double centred = signal[i] - mean;
+        sum += centred * centred;
+    }
+    return sum;
+}
+
+template <class T>
+inline double centredSumOfProducts(double meanA, double meanB,
+                                   const T *signalA, const T *signalB, size_t valueNb)
+{
+    double sum = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        sum += (signalA[i] - meanA) * (signalB[i] - meanB);
+    }
+    return sum;
+}
+
+template <class T>
+inline void minMax(const T *signal, size_t valueNb, T &min, T &max)
+{
+    for (size_t i = 0; i < valueNb; i++) {
+        min = std::min(min, signal[i]);
+        max = std::max(max, signal[i]);
+    }
+}
+
+template <class T>
+inline size_t zeroCrossings(const T *signal, size_t valueNb)
+{
+    size_t crossingNb = 0;
+    for (size_t i = 1; i < valueNb; i++) {
+        crossingNb += (signal[i] < 0) != (signal[i - 1] < 0);
+    }
+    return crossingNb;
+}
+
+template <class T>
+inline size_t clippedValues(const T *signal, size_t valueNb, T clipLevel)
+{
+    size_t clippedNb = 0;
+    for (size_t i = 0; i < valueNb; i++) {
+        clippedNb += signal[i] >= clipLevel || signal[i] <= -clipLevel;
+    }
+    return clippedNb;
+}
+
+}
+
+#if defined(AUDIOUTILITIES_SIMD_X86)
+
+/** SSE2 kernels.
+ *
+ *  8 and 16 bits samples are multiplied and pairwise added to 32 bits lanes
+ *  (pmaddwd) then widened to 64 bits accumulators.
+ */
+namespace sse2
+{
+
+#define AUDIOUTILITIES_SSE2 __attribute__((target("sse2")))
+
+/** Loads samples as 16 bits lanes. */
+template <class T>
+struct Loader;
+
+template <>
+struct Loader<int16_t>
+{
+    static const size_t step = 8;
+    static const size_t vectorNb = 1;
+
+    static inline AUDIOUTILITIES_SSE2 void load(const int16_t *values, __m128i *vectors)
+    {
+        vectors[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+    }
+};
+
+template <>
+struct Loader<int8_t>
+{
+    static const size_t step = 16;
+    static const size_t vectorNb = 2;
+
+    static inline AUDIOUTILITIES_SSE2 void load(const int8_t *values, __m128i *vectors)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+        // Sign extension: duplicate each byte and arithmetic shift
+        vectors[0] = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+        vectors[1] = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+    }
+};
+
+/** Add the 4 signed 32 bits lanes of value to the 2 64 bits lanes of accumulator. */
+static inline AUDIOUTILITIES_SSE2 __m128i accumulate(__m128i accumulator, __m128i value)
+{
+    __m128i sign = _mm_srai_epi32(value, 31);
+    accumulator = _mm_add_epi64(accumulator, _mm_unpacklo_epi32(value, sign));
+    return _mm_add_epi64(accumulator, _mm_unpackhi_epi32(value, sign));
+}
+
+/** Same as accumulate for a pmaddwd result, which overflows to INT32_MIN
+ *  only for (-32768 * -32768) * 2 = 2^31. */
+static inline AUDIOUTILITIES_SSE2 __m128i accumulateMadd(__m128i accumulator, __m128i value)
+{
+    __m128i overflow = _mm_cmpeq_epi32(value, _mm_set1_epi32(INT32_MIN));
+    __m128i sign = _mm_andnot_si128(overflow, _mm_srai_epi32(value, 31));
+    accumulator = _mm_add_epi64(accumulator, _mm_unpacklo_epi32(value, sign));
+    return _mm_add_epi64(accumulator, _mm_unpackhi_epi32(value, sign));
+}
+
+static inline AUDIOUTILITIES_SSE2 int64_t horizontalSum(__m128i accumulator)
+{
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), accumulator);
+    return lanes[0] + lanes[1];
+}
+
+static inline AUDIOUTILITIES_SSE2 double horizontalSum(__m128d accumulator)
+{
+    double lanes[2];
+    _mm_storeu_pd(lanes, accumulator);
+    return lanes[0] + lanes[1];
+}
+
+template <class T>
+inline AUDIOUTILITIES_SSE2 int64_t sum(const T *signal, size_t valueNb)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i accumulator = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + Loader<T>::step <= valueNb; i += Loader<T>::step) {
+        __m128i vectors[Loader<T>::vectorNb];
+        Loader<T>::load(signal + i, vectors);
+        for (size_t v = 0; v < Loader<T>::vectorNb; v++) {
+            accumulator = accumulate(accumulator, _mm_madd_epi16(vectors[v], ones));
+        }
+    }
+    return horizontalSum(accumulator) + scalar::sum(signal + i, valueNb - i);
+}
+
+template <>
+inline AUDIOUTILITIES_SSE2 int64_t sum<int32_t>(const int32_t *signal, size_t valueNb)
+{
+    __m128i accumulator = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        accumulator = accumulate(accumulator,
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i)));
+    }
+    return horizontalSum(accumulator) + scalar::sum(signal + i, valueNb - i);
+}
+
+template <class T>
+inline AUDIOUTILITIES_SSE2 int64_t sumOfSquares(const T *signal, size_t valueNb)
+{
+    __m128i accumulator = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + Loader<T>::step <= valueNb; i += Loader<T>::step) {
+        __m128i vectors[Loader<T>::vectorNb];
+        Loader<T>::load(signal + i, vectors);
+        for (size_t v = 0; v < Loader<T>::vectorNb; v++) {
+            accumulator = accumulateMadd(accumulator, _mm_madd_epi16(vectors[v], vectors[v]));
+        }
+    }
+    return horizontalSum(accumulator) + scalar::sumOfSquares(signal + i, valueNb - i);
+}
+
+template <class T>
+inline AUDIOUTILITIES_SSE2 void productSums(const T *signalA, const T *signalB, size_t valueNb,
+                                            int64_t &sumA, int64_t &sumB, int64_t &sumAB)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i accumulatorA = _mm_setzero_si128();
+    __m128i accumulatorB = _mm_setzero_si128();
+    __m128i accumulatorAB = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + Loader<T>::step <= valueNb; i += Loader<T>::step) {
+        __m128i vectorsA[Loader<T>::vectorNb];
+        __m128i vectorsB[Loader<T>::vectorNb];
+        Loader<T>::load(signalA + i, vectorsA);
+        Loader<T>::load(signalB + i, vectorsB);
+        for (size_t v = 0; v < Loader<T>::vectorNb; v++) {
+            accumulatorA = accumulate(accumulatorA, _mm_madd_epi16(vectorsA[v], ones));
+            accumulatorB = accumulate(accumulatorB, _mm_madd_epi16(vectorsB[v], ones));
+            accumulatorAB = accumulateMadd(accumulatorAB,
+                                           _mm_madd_epi16(vectorsA[v], vectorsB[v]));
+        }
+    }
+    scalar::productSums(signalA + i, signalB + i, valueNb - i, sumA, sumB, sumAB);
+    sumA += horizontalSum(accumulatorA);
+    sumB += horizontalSum(accumulatorB);
+    sumAB += horizontalSum(accumulatorAB);
+}
+
+inline AUDIOUTILITIES_SSE2 double centredSumOfSquares(double mean, const int32_t *signal,
+                                                      size_t valueNb)
+{
+    const __m128d means = _mm_set1_pd(mean);
+    __m128d accumulator = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i));
+        __m128d low = _mm_sub_pd(_mm_cvtepi32_pd(values), means);
+        __m128d high = _mm_sub_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(values, values)), means);
+        accumulator = _mm_add_pd(accumulator, _mm_mul_pd(low, low));
+        accumulator = _mm_add_pd(accumulator, _mm_mul_pd(high, high));
+    }
+    return horizontalSum(accumulator) + scalar::centredSumOfSquares(mean, signal + i, valueNb - i);
+}
+
+inline AUDIOUTILITIES_SSE2 double centredSumOfProducts(double meanA, double meanB,
+                                                       const int32_t *signalA,
+                                                       const int32_t *signalB,
+                                                       size_t valueNb)
+{
+    const __m128d meansA = _mm_set1_pd(meanA);
+    const __m128d meansB = _mm_set1_pd(meanB);
+    __m128d accumulator = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m128i valuesA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signalA + i));
+        __m128i valuesB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signalB + i));
+        __m128d lowA = _mm_sub_pd(_mm_cvtepi32_pd(valuesA), meansA);
+        __m128d lowB = _mm_sub_pd(_mm_cvtepi32_pd(valuesB), meansB);
+        __m128d highA = _mm_sub_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(valuesA, valuesA)), meansA);
+        __m128d highB = _mm_sub_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(valuesB, valuesB)), meansB);
+        accumulator = _mm_add_pd(accumulator, _mm_mul_pd(lowA, lowB));
+        accumulator = _mm_add_pd(accumulator, _mm_mul_pd(highA, highB));
+    }
+    return horizontalSum(accumulator) +
+           scalar::centredSumOfProducts(meanA, meanB, signalA + i, signalB + i, valueNb - i);
+}
+
+/** Reduce the lanes of min and max vectors into scalars. */
+template <class Lane, class T>
+inline AUDIOUTILITIES_SSE2 void reduceMinMax(__m128i minVector, __m128i maxVector, T &min, T &max)
+{
+    const size_t laneNb = sizeof(__m128i) / sizeof(Lane);
+    Lane mins[laneNb];
+    Lane maxs[laneNb];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(mins), minVector);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(maxs), maxVector);
+    for (size_t lane = 0; lane < laneNb; lane++) {
+        min = std::min<T>(min, mins[lane]);
+        max = std::max<T>(max, maxs[lane]);
+    }
+}
+
+/** Samples are compared as 16 bits lanes. */
+template <class T>
+inline AUDIOUTILITIES_SSE2 void minMax(const T *signal, size_t valueNb, T &min, T &max)
+{
+    __m128i minVector = _mm_set1_epi16(min);
+    __m128i maxVector = _mm_set1_epi16(max);
+    size_t i = 0;
+    for (; i + Loader<T>::step <= valueNb; i += Loader<T>::step) {
+        __m128i vectors[Loader<T>::vectorNb];
+        Loader<T>::load(signal + i, vectors);
+        for (size_t v = 0; v < Loader<T>::vectorNb; v++) {
+            minVector = _mm_min_epi16(minVector, vectors[v]);
+            maxVector = _mm_max_epi16(maxVector, vectors[v]);
+        }
+    }
+    reduceMinMax<int16_t>(minVector, maxVector, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+/** No 32 bits min and max before SSE4.1, select with comparison masks. */
+template <>
+inline AUDIOUTILITIES_SSE2 void minMax<int32_t>(const int32_t *signal, size_t valueNb,
+                                                int32_t &min, int32_t &max)
+{
+    __m128i minVector = _mm_set1_epi32(min);
+    __m128i maxVector = _mm_set1_epi32(max);
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i));
+        __m128i lower = _mm_cmplt_epi32(values, minVector);
+        __m128i greater = _mm_cmpgt_epi32(values, maxVector);
+        minVector = _mm_or_si128(_mm_and_si128(lower, values), _mm_andnot_si128(lower, minVector));
+        maxVector = _mm_or_si128(_mm_and_si128(greater, values),
+                                 _mm_andnot_si128(greater, maxVector));
+    }
+    reduceMinMax<int32_t>(minVector, maxVector, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+/** @return the sum of the 4 32 bits lanes of counts. */
+static inline AUDIOUTILITIES_SSE2 size_t horizontalCount(__m128i counts)
+{
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), counts);
+    return size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+/** Signs are compared with the sign bit of the exclusive or of neighbours,
+ *  each crossing giving a -1 lane that is pairwise added to 32 bits counts. */
+template <class T>
+inline AUDIOUTILITIES_SSE2 size_t zeroCrossings(const T *signal, size_t valueNb)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 1;
+    for (; i + Loader<T>::step <= valueNb; i += Loader<T>::step) {
+        __m128i vectors[Loader<T>::vectorNb];
+        __m128i previous[Loader<T>::vectorNb];
+        Loader<T>::load(signal + i, vectors);
+        Loader<T>::load(signal + i - 1, previous);
+        for (size_t v = 0; v < Loader<T>::vectorNb; v++) {
+            __m128i crossing = _mm_srai_epi16(_mm_xor_si128(vectors[v], previous[v]), 15);
+            counts = _mm_sub_epi32(counts, _mm_madd_epi16(crossing, ones));
+        }
+    }
+    return horizontalCount(counts) + scalar::zeroCrossings(signal + i - 1, valueNb - i + 1);
+}
+
+template <>
+inline AUDIOUTILITIES_SSE2 size_t zeroCrossings<int32_t>(const int32_t *signal, size_t valueNb)
+{
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 1;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i));
+        __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i - 1));
+        counts = _mm_sub_epi32(counts, _mm_srai_epi32(_mm_xor_si128(values, previous), 31));
+    }
+    return horizontalCount(counts) + scalar::zeroCrossings(signal + i - 1, valueNb - i + 1);
+}
+
+template <class T>
+inline AUDIOUTILITIES_SSE2 size_t clippedValues(const T *signal, size_t valueNb, T clipLevel)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i high = _mm_set1_epi16(clipLevel - 1);
+    const __m128i low = _mm_set1_epi16(1 - clipLevel);
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + Loader<T>::step <= valueNb; i += Loader<T>::step) {
+        __m128i vectors[Loader<T>::vectorNb];
+        Loader<T>::load(signal + i, vectors);
+        for (size_t v = 0; v < Loader<T>::vectorNb; v++) {
+            __m128i clipped = _mm_or_si128(_mm_cmpgt_epi16(vectors[v], high),
+                                           _mm_cmplt_epi16(vectors[v], low));
+            counts = _mm_sub_epi32(counts, _mm_madd_epi16(clipped, ones));
+        }
+    }
+    return horizontalCount(counts) + scalar::clippedValues(signal + i, valueNb - i, clipLevel);
+}
+
+template <>
+inline AUDIOUTILITIES_SSE2 size_t clippedValues<int32_t>(const int32_t *signal, size_t valueNb,
+                                                         int32_t clipLevel)
+{
+    const __m128i high = _mm_set1_epi32(clipLevel - 1);
+    const __m128i low = _mm_set1_epi32(1 - clipLevel);
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i));
+        __m128i clipped = _mm_or_si128(_mm_cmpgt_epi32(values, high),
+                                       _mm_cmplt_epi32(values, low));
+        counts = _mm_sub_epi32(counts, clipped);
+    }
+    return horizontalCount(counts) + scalar::clippedValues(signal + i, valueNb - i, clipLevel);
+}
+
+#undef AUDIOUTILITIES_SSE2
+
+}
+
+/** AVX2 kernels, same algorithms than the SSE2 ones on 256 bits vectors. */
+namespace avx2
+{
+
+#define AUDIOUTILITIES_AVX2 __attribute__((target("avx2")))
+
+/** Loads 16 samples as 16 bits lanes. */
+template <class T>
+struct Loader;
+
+template <>
+struct Loader<int16_t>
+{
+    static inline AUDIOUTILITIES_AVX2 __m256i load(const int16_t *values)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values));
+    }
+};
+
+template <>
+struct Loader<int8_t>
+{
+    static inline AUDIOUTILITIES_AVX2 __m256i load(const int8_t *values)
+    {
+        return _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values)));
+    }
+};
+
+static const size_t step = 16;
+
+/** Add the 8 signed 32 bits lanes of value to the 4 64 bits lanes of accumulator. */
+static inline AUDIOUTILITIES_AVX2 __m256i accumulate(__m256i accumulator, __m256i value)
+{
+    accumulator = _mm256_add_epi64(accumulator,
+                                   _mm256_cvtepi32_epi64(_mm256_castsi256_si128(value)));
+    return _mm256_add_epi64(accumulator,
+                            _mm256_cvtepi32_epi64(_mm256_extracti128_si256(value, 1)));
+}
+
+/** @see sse2::accumulateMadd */
+static inline AUDIOUTILITIES_AVX2 __m256i accumulateMadd(__m256i accumulator, __m256i value)
+{
+    const __m256i overflow = _mm256_set1_epi64x(INT32_MIN);
+    const __m256i correction = _mm256_set1_epi64x(int64_t(1) << 32);
+
+    __m256i low = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(value));
+    __m256i high = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(value, 1));
+    low = _mm256_add_epi64(low, _mm256_and_si256(_mm256_cmpeq_epi64(low, overflow), correction));
+    high = _mm256_add_epi64(high, _mm256_and_si256(_mm256_cmpeq_epi64(high, overflow), correction));
+    return _mm256_add_epi64(accumulator, _mm256_add_epi64(low, high));
+}
+
+static inline AUDIOUTILITIES_AVX2 int64_t horizontalSum(__m256i accumulator)
+{
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), accumulator);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static inline AUDIOUTILITIES_AVX2 double horizontalSum(__m256d accumulator)
+{
+    double lanes[4];
+    _mm256_storeu_pd(lanes, accumulator);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+template <class T>
+inline AUDIOUTILITIES_AVX2 int64_t sum(const T *signal, size_t valueNb)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i accumulator = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        accumulator = accumulate(accumulator, _mm256_madd_epi16(Loader<T>::load(signal + i), ones));
+    }
+    return horizontalSum(accumulator) + scalar::sum(signal + i, valueNb - i);
+}
+
+template <>
+inline AUDIOUTILITIES_AVX2 int64_t sum<int32_t>(const int32_t *signal, size_t valueNb)
+{
+    __m256i accumulator = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= valueNb; i += 8) {
+        accumulator = accumulate(accumulator,
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(signal + i)));
+    }
+    return horizontalSum(accumulator) + scalar::sum(signal + i, valueNb - i);
+}
+
+template <class T>
+inline AUDIOUTILITIES_AVX2 int64_t sumOfSquares(const T *signal, size_t valueNb)
+{
+    __m256i accumulator = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        __m256i values = Loader<T>::load(signal + i);
+        accumulator = accumulateMadd(accumulator, _mm256_madd_epi16(values, values));
+    }
+    return horizontalSum(accumulator) + scalar::sumOfSquares(signal + i, valueNb - i);
+}
+
+template <class T>
+inline AUDIOUTILITIES_AVX2 void productSums(const T *signalA, const T *signalB, size_t valueNb,
+                                            int64_t &sumA, int64_t &sumB, int64_t &sumAB)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i accumulatorA = _mm256_setzero_si256();
+    __m256i accumulatorB = _mm256_setzero_si256();
+    __m256i accumulatorAB = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        __m256i valuesA = Loader<T>::load(signalA + i);
+        __m256i valuesB = Loader<T>::load(signalB + i);
+        accumulatorA = accumulate(accumulatorA, _mm256_madd_epi16(valuesA, ones));
+        accumulatorB = accumulate(accumulatorB, _mm256_madd_epi16(valuesB, ones));
+        accumulatorAB = accumulateMadd(accumulatorAB, _mm256_madd_epi16(valuesA, valuesB));
+    }
+    scalar::productSums(signalA + i, signalB + i, valueNb - i, sumA, sumB, sumAB);
+    sumA += horizontalSum(accumulatorA);
+    sumB += horizontalSum(accumulatorB);
+    sumAB += horizontalSum(accumulatorAB);
+}
+
+inline AUDIOUTILITIES_AVX2 double centredSumOfSquares(double mean, const int32_t *signal,
+                                                      size_t valueNb)
+{
+    const __m256d means = _mm256_set1_pd(mean);
+    __m256d accumulator = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m256d values = _mm256_sub_pd(
+            _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(signal + i))),
+            means);
+        accumulator = _mm256_add_pd(accumulator, _mm256_mul_pd(values, values));
+    }
+    return horizontalSum(accumulator) + scalar::centredSumOfSquares(mean, signal + i, valueNb - i);
+}
+
+inline AUDIOUTILITIES_AVX2 double centredSumOfProducts(double meanA, double meanB,
+                                                       const int32_t *signalA,
+                                                       const int32_t *signalB,
+                                                       size_t valueNb)
+{
+    const __m256d meansA = _mm256_set1_pd(meanA);
+    const __m256d meansB = _mm256_set1_pd(meanB);
+    __m256d accumulator = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        __m256d valuesA = _mm256_sub_pd(
+            _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(signalA + i))),
+            meansA);
+        __m256d valuesB = _mm256_sub_pd(
+            _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(signalB + i))),
+            meansB);
+        accumulator = _mm256_add_pd(accumulator, _mm256_mul_pd(valuesA, valuesB));
+    }
+    return horizontalSum(accumulator) +
+           scalar::centredSumOfProducts(meanA, meanB, signalA + i, signalB + i, valueNb - i);
+}
+
+template <class Lane, class T>
+inline AUDIOUTILITIES_AVX2 void reduceMinMax(__m256i minVector, __m256i maxVector, T &min, T &max)
+{
+    const size_t laneNb = sizeof(__m256i) / sizeof(Lane);
+    Lane mins[laneNb];
+    Lane maxs[laneNb];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(mins), minVector);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(maxs), maxVector);
+    for (size_t lane = 0; lane < laneNb; lane++) {
+        min = std::min<T>(min, mins[lane]);
+        max = std::max<T>(max, maxs[lane]);
+    }
+}
+
+template <class T>
+inline AUDIOUTILITIES_AVX2 void minMax(const T *signal, size_t valueNb, T &min, T &max)
+{
+    __m256i minVector = _mm256_set1_epi16(min);
+    __m256i maxVector = _mm256_set1_epi16(max);
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        __m256i values = Loader<T>::load(signal + i);
+        minVector = _mm256_min_epi16(minVector, values);
+        maxVector = _mm256_max_epi16(maxVector, values);
+    }
+    reduceMinMax<int16_t>(minVector, maxVector, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+template <>
+inline AUDIOUTILITIES_AVX2 void minMax<int32_t>(const int32_t *signal, size_t valueNb,
+                                                int32_t &min, int32_t &max)
+{
+    __m256i minVector = _mm256_set1_epi32(min);
+    __m256i maxVector = _mm256_set1_epi32(max);
+    size_t i = 0;
+    for (; i + 8 <= valueNb; i += 8) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(signal + i));
+        minVector = _mm256_min_epi32(minVector, values);
+        maxVector = _mm256_max_epi32(maxVector, values);
+    }
+    reduceMinMax<int32_t>(minVector, maxVector, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+static inline AUDIOUTILITIES_AVX2 size_t horizontalCount(__m256i counts)
+{
+    uint32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), counts);
+    size_t count = 0;
+    for (size_t lane = 0; lane < 8; lane++) {
+        count += lanes[lane];
+    }
+    return count;
+}
+
+template <class T>
+inline AUDIOUTILITIES_AVX2 size_t zeroCrossings(const T *signal, size_t valueNb)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 1;
+    for (; i + step <= valueNb; i += step) {
+        __m256i crossing = _mm256_srai_epi16(
+            _mm256_xor_si256(Loader<T>::load(signal + i), Loader<T>::load(signal + i - 1)), 15);
+        counts = _mm256_sub_epi32(counts, _mm256_madd_epi16(crossing, ones));
+    }
+    return horizontalCount(counts) + scalar::zeroCrossings(signal + i - 1, valueNb - i + 1);
+}
+
+template <>
+inline AUDIOUTILITIES_AVX2 size_t zeroCrossings<int32_t>(const int32_t *signal, size_t valueNb)
+{
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 1;
+    for (; i + 8 <= valueNb; i += 8) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(signal + i));
+        __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(signal + i - 1));
+        counts = _mm256_sub_epi32(counts,
+                                  _mm256_srai_epi32(_mm256_xor_si256(values, previous), 31));
+    }
+    return horizontalCount(counts) + scalar::zeroCrossings(signal + i - 1, valueNb - i + 1);
+}
+
+template <class T>
+inline AUDIOUTILITIES_AVX2 size_t clippedValues(const T *signal, size_t valueNb, T clipLevel)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i high = _mm256_set1_epi16(clipLevel - 1);
+    const __m256i low = _mm256_set1_epi16(1 - clipLevel);
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        __m256i values = Loader<T>::load(signal + i);
+        __m256i clipped = _mm256_or_si256(_mm256_cmpgt_epi16(values, high),
+                                          _mm256_cmpgt_epi16(low, values));
+        counts = _mm256_sub_epi32(counts, _mm256_madd_epi16(clipped, ones));
+    }
+    return horizontalCount(counts) + scalar::clippedValues(signal + i, valueNb - i, clipLevel);
+}
+
+template <>
+inline AUDIOUTILITIES_AVX2 size_t clippedValues<int32_t>(const int32_t *signal, size_t valueNb,
+                                                         int32_t clipLevel)
+{
+    const __m256i high = _mm256_set1_epi32(clipLevel - 1);
+    const __m256i low = _mm256_set1_epi32(1 - clipLevel);
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= valueNb; i += 8) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(signal + i));
+        __m256i clipped = _mm256_or_si256(_mm256_cmpgt_epi32(values, high),
+                                          _mm256_cmpgt_epi32(low, values));
+        counts = _mm256_sub_epi32(counts, clipped);
+    }
+    return horizontalCount(counts) + scalar::clippedValues(signal + i, valueNb - i, clipLevel);
+}
+
+#undef AUDIOUTILITIES_AVX2
+
+}
+
+#endif /* AUDIOUTILITIES_SIMD_X86 */
+
+#if defined(AUDIOUTILITIES_SIMD_NEON)
+
+/** NEON kernels.
+ *
+ *  Samples are multiplied with widening to 32 bits (vmull), which can not
+ *  overflow, then pairwise accumulated to 64 bits lanes (vpadal).
+ */
+namespace neon
+{
+
+/** Loads 8 samples as 16 bits lanes. */
+template <class T>
+struct Loader;
+
+template <>
+struct Loader<int16_t>
+{
+    static inline int16x8_t load(const int16_t *values) { return vld1q_s16(values); }
+};
+
+template <>
+struct Loader<int8_t>
+{
+    static inline int16x8_t load(const int8_t *values) { return vmovl_s8(vld1_s8(values)); }
+};
+
+static const size_t step = 8;
+
+static inline int64_t horizontalSum(int64x2_t accumulator)
+{
+    return vgetq_lane_s64(accumulator, 0) + vgetq_lane_s64(accumulator, 1);
+}
+
+static inline int64x2_t accumulateProducts(int64x2_t accumulator, int16x8_t a, int16x8_t b)
+{
+    accumulator = vpadalq_s32(accumulator, vmull_s16(vget_low_s16(a), vget_low_s16(b)));
+    return vpadalq_s32(accumulator, vmull_s16(vget_high_s16(a), vget_high_s16(b)));
+}
+
+template <class T>
+inline int64_t sum(const T *signal, size_t valueNb)
+{
+    int64x2_t accumulator = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        accumulator = vpadalq_s32(accumulator, vpaddlq_s16(Loader<T>::load(signal + i)));
+    }
+    return horizontalSum(accumulator) + scalar::sum(signal + i, valueNb - i);
+}
+
+template <>
+inline int64_t sum<int32_t>(const int32_t *signal, size_t valueNb)
+{
+    int64x2_t accumulator = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        accumulator = vpadalq_s32(accumulator, vld1q_s32(signal + i));
+    }
+    return horizontalSum(accumulator) + scalar::sum(signal + i, valueNb - i);
+}
+
+template <class T>
+inline int64_t sumOfSquares(const T *signal, size_t valueNb)
+{
+    int64x2_t accumulator = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        int16x8_t values = Loader<T>::load(signal + i);
+        accumulator = accumulateProducts(accumulator, values, values);
+    }
+    return horizontalSum(accumulator) + scalar::sumOfSquares(signal + i, valueNb - i);
+}
+
+template <class T>
+inline void productSums(const T *signalA, const T *signalB, size_t valueNb,
+                        int64_t &sumA, int64_t &sumB, int64_t &sumAB)
+{
+    int64x2_t accumulatorA = vdupq_n_s64(0);
+    int64x2_t accumulatorB = vdupq_n_s64(0);
+    int64x2_t accumulatorAB = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        int16x8_t valuesA = Loader<T>::load(signalA + i);
+        int16x8_t valuesB = Loader<T>::load(signalB + i);
+        accumulatorA = vpadalq_s32(accumulatorA, vpaddlq_s16(valuesA));
+        accumulatorB = vpadalq_s32(accumulatorB, vpaddlq_s16(valuesB));
+        accumulatorAB = accumulateProducts(accumulatorAB, valuesA, valuesB);
+    }
+    scalar::productSums(signalA + i, signalB + i, valueNb - i, sumA, sumB, sumAB);
+    sumA += horizontalSum(accumulatorA);
+    sumB += horizontalSum(accumulatorB);
+    sumAB += horizontalSum(accumulatorAB);
+}
+
+inline void minMax(const int8_t *signal, size_t valueNb, int8_t &min, int8_t &max)
+{
+    int8x16_t minVector = vdupq_n_s8(min);
+    int8x16_t maxVector = vdupq_n_s8(max);
+    size_t i = 0;
+    for (; i + 16 <= valueNb; i += 16) {
+        int8x16_t values = vld1q_s8(signal + i);
+        minVector = vminq_s8(minVector, values);
+        maxVector = vmaxq_s8(maxVector, values);
+    }
+    int8_t mins[16];
+    int8_t maxs[16];
+    vst1q_s8(mins, minVector);
+    vst1q_s8(maxs, maxVector);
+    scalar::minMax(mins, 16, min, max);
+    scalar::minMax(maxs, 16, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+inline void minMax(const int16_t *signal, size_t valueNb, int16_t &min, int16_t &max)
+{
+    int16x8_t minVector = vdupq_n_s16(min);
+    int16x8_t maxVector = vdupq_n_s16(max);
+    size_t i = 0;
+    for (; i + 8 <= valueNb; i += 8) {
+        int16x8_t values = vld1q_s16(signal + i);
+        minVector = vminq_s16(minVector, values);
+        maxVector = vmaxq_s16(maxVector, values);
+    }
+    int16_t mins[8];
+    int16_t maxs[8];
+    vst1q_s16(mins, minVector);
+    vst1q_s16(maxs, maxVector);
+    scalar::minMax(mins, 8, min, max);
+    scalar::minMax(maxs, 8, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+inline void minMax(const int32_t *signal, size_t valueNb, int32_t &min, int32_t &max)
+{
+    int32x4_t minVector = vdupq_n_s32(min);
+    int32x4_t maxVector = vdupq_n_s32(max);
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        int32x4_t values = vld1q_s32(signal + i);
+        minVector = vminq_s32(minVector, values);
+        maxVector = vmaxq_s32(maxVector, values);
+    }
+    int32_t mins[4];
+    int32_t maxs[4];
+    vst1q_s32(mins, minVector);
+    vst1q_s32(maxs, maxVector);
+    scalar::minMax(mins, 4, min, max);
+    scalar::minMax(maxs, 4, min, max);
+    scalar::minMax(signal + i, valueNb - i, min, max);
+}
+
+/** Counts are accumulated negated, each event giving a -1 lane. */
+static inline size_t horizontalCount(int32x4_t negatedCounts)
+{
+    int64_t negatedCount = int64_t(vgetq_lane_s32(negatedCounts, 0)) +
+                           vgetq_lane_s32(negatedCounts, 1) +
+                           vgetq_lane_s32(negatedCounts, 2) +
+                           vgetq_lane_s32(negatedCounts, 3);
+    return size_t(-negatedCount);
+}
+
+template <class T>
+inline size_t zeroCrossings(const T *signal, size_t valueNb)
+{
+    int32x4_t counts = vdupq_n_s32(0);
+    size_t i = 1;
+    for (; i + step <= valueNb; i += step) {
+        int16x8_t crossing = vshrq_n_s16(
+            veorq_s16(Loader<T>::load(signal + i), Loader<T>::load(signal + i - 1)), 15);
+        counts = vpadalq_s16(counts, crossing);
+    }
+    return horizontalCount(counts) + scalar::zeroCrossings(signal + i - 1, valueNb - i + 1);
+}
+
+template <>
+inline size_t zeroCrossings<int32_t>(const int32_t *signal, size_t valueNb)
+{
+    int32x4_t counts = vdupq_n_s32(0);
+    size_t i = 1;
+    for (; i + 4 <= valueNb; i += 4) {
+        int32x4_t crossing = vshrq_n_s32(veorq_s32(vld1q_s32(signal + i),
+                                                   vld1q_s32(signal + i - 1)), 31);
+        counts = vaddq_s32(counts, crossing);
+    }
+    return horizontalCount(counts) + scalar::zeroCrossings(signal + i - 1, valueNb - i + 1);
+}
+
+template <class T>
+inline size_t clippedValues(const T *signal, size_t valueNb, T clipLevel)
+{
+    const int16x8_t high = vdupq_n_s16(clipLevel);
+    const int16x8_t low = vdupq_n_s16(-clipLevel);
+    int32x4_t counts = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + step <= valueNb; i += step) {
+        int16x8_t values = Loader<T>::load(signal + i);
+        uint16x8_t clipped = vorrq_u16(vcgeq_s16(values, high), vcleq_s16(values, low));
+        counts = vpadalq_s16(counts, vreinterpretq_s16_u16(clipped));
+    }
+    return horizontalCount(counts) + scalar::clippedValues(signal + i, valueNb - i, clipLevel);
+}
+
+template <>
+inline size_t clippedValues<int32_t>(const int32_t *signal, size_t valueNb, int32_t clipLevel)
+{
+    const int32x4_t high = vdupq_n_s32(clipLevel);
+    const int32x4_t low = vdupq_n_s32(-clipLevel);
+    int32x4_t counts = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        int32x4_t values = vld1q_s32(signal + i);
+        uint32x4_t clipped = vorrq_u32(vcgeq_s32(values, high), vcleq_s32(values, low));
+        counts = vaddq_s32(counts, vreinterpretq_s32_u32(clipped));
+    }
+    return horizontalCount(counts) + scalar::clippedValues(signal + i, valueNb - i, clipLevel);
+}
+
+#if defined(__aarch64__)
+
+inline double centredSumOfSquares(double mean, const int32_t *signal, size_t valueNb)
+{
+    const float64x2_t means = vdupq_n_f64(mean);
+    float64x2_t accumulator = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        int32x4_t values = vld1q_s32(signal + i);
+        float64x2_t low = vsubq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(values))), means);
+        float64x2_t high = vsubq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(values))), means);
+        accumulator = vaddq_f64(accumulator, vmulq_f64(low, low));
+        accumulator = vaddq_f64(accumulator, vmulq_f64(high, high));
+    }
+    return vaddvq_f64(accumulator) + scalar::centredSumOfSquares(mean, signal + i, valueNb - i);
+}
+
+inline double centredSumOfProducts(double meanA, double meanB,
+                                   const int32_t *signalA, const int32_t *signalB,
+                                   size_t valueNb)
+{
+    const float64x2_t meansA = vdupq_n_f64(meanA);
+    const float64x2_t meansB = vdupq_n_f64(meanB);
+    float64x2_t accumulator = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 4 <= valueNb; i += 4) {
+        int32x4_t valuesA = vld1q_s32(signalA + i);
+        int32x4_t valuesB = vld1q_s32(signalB + i);
+        float64x2_t lowA = vsubq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(valuesA))), meansA);
+        float64x2_t lowB = vsubq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(valuesB))), meansB);
+        float64x2_t highA = vsubq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(valuesA))), meansA);
+        float64x2_t highB = vsubq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(valuesB))), meansB);
+        accumulator = vaddq_f64(accumulator, vmulq_f64(lowA, lowB));
+        accumulator = vaddq_f64(accumulator, vmulq_f64(highA, highB));
+    }
+    return vaddvq_f64(accumulator) +
+           scalar::centredSumOfProducts(meanA, meanB, signalA + i, signalB + i, valueNb - i);
+}
+
+#else
+
+/* No double precision vectors on armv7, fallback on the portable version. */
+using scalar::centredSumOfSquares;
+using scalar::centredSumOfProducts;
+
+#endif
+
+}
+
+#endif /* AUDIOUTILITIES_SIMD_NEON */
+
+/** Dispatch a kernel call to the implementation of the current level. */
+#if defined(AUDIOUTILITIES_SIMD_X86)
+#define AUDIOUTILITIES_SIMD_DISPATCH(kernel, args)  \
+    switch (getSimdLevel()) {                       \
+    case SimdAvx2:                                  \
+        return avx2::kernel args;                   \
+    case SimdSse2:                                  \
+        return sse2::kernel args;                   \
+    default:                                        \
+        return scalar::kernel args;                 \
+    }
+#elif defined(AUDIOUTILITIES_SIMD_NEON)
+#define AUDIOUTILITIES_SIMD_DISPATCH(kernel, args)  \
+    switch (getSimdLevel()) {                       \
+    case SimdNeon:                                  \
+        return neon::kernel args;                   \
+    default:                                        \
+        return scalar::kernel args;                 \
+    }
+#else
+#define AUDIOUTILITIES_SIMD_DISPATCH(kernel, args)  \
+    return scalar::kernel args;
+#endif
+
+/** @return the exact sum of the values of a signal. */
+template <class T>
+inline int64_t sum(const T *signal, size_t valueNb)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(sum, (signal, valueNb))
+}
+
+/** @return the exact sum of the squared values of a 8 or 16 bits signal. */
+template <class T>
+inline int64_t sumOfSquares(const T *signal, size_t valueNb)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(sumOfSquares, (signal, valueNb))
+}
+
+/** Compute in one pass the exact sums of A, B and A * B for 8 or 16 bits signals. */
+template <class T>
+inline void productSums(const T *signalA, const T *signalB, size_t valueNb,
+                        int64_t &sumA, int64_t &sumB, int64_t &sumAB)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(productSums, (signalA, signalB, valueNb, sumA, sumB, sumAB))
+}
+
+/** @return sum((signal(t) - mean)^2) for a 32 bits signal. */
+inline double centredSumOfSquares(double mean, const int32_t *signal, size_t valueNb)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(centredSumOfSquares, (mean, signal, valueNb))
+}
+
+/** @return sum((A(t) - meanA) * (B(t) - meanB)) for 32 bits signals. */
+inline double centredSumOfProducts(double meanA, double meanB,
+                                   const int32_t *signalA, const int32_t *signalB,
+                                   size_t valueNb)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(centredSumOfProducts,
+                                 (meanA, meanB, signalA, signalB, valueNb))
+}
+
+/** Update min and max with the values of a signal. */
+template <class T>
+inline void minMax(const T *signal, size_t valueNb, T &min, T &max)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(minMax, (signal, valueNb, min, max))
+}
+
+/** @return the number of consecutive values of different signs, 0 being positive. */
+template <class T>
+inline size_t zeroCrossings(const T *signal, size_t valueNb)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(zeroCrossings, (signal, valueNb))
+}
+
+/** @return the number of values whose absolute value is at least clipLevel > 0. */
+template <class T>
+inline size_t clippedValues(const T *signal, size_t valueNb, T clipLevel)
+{
+    AUDIOUTILITIES_SIMD_DISPATCH(clippedValues, (signal, valueNb, clipLevel))
+}
+
+#undef AUDIOUTILITIES_SIMD_DISPATCH
+
+/* float signals are only handled by the portable kernels, in double. */
+
+/** @return the sum of the values of a float signal. */
+inline double sum(const float *signal, size_t valueNb)
+{
+    return scalar::sum(signal, valueNb);
+}
+
+/** @return sum((signal(t) - mean)^2) for a float signal. */
+inline double centredSumOfSquares(double mean, const float *signal, size_t valueNb)
+{
+    return scalar::centredSumOfSquares(mean, signal, valueNb);
+}
+
+/** @return sum((A(t) - meanA) * (B(t) - meanB)) for float signals. */
+inline double centredSumOfProducts(double meanA, double meanB,
+                                   const float *signalA, const float *signalB,
+                                   size_t valueNb)
+{
+    return scalar::centredSumOfProducts(meanA, meanB, signalA, signalB, valueNb);
+}
+
+/** Update min and max with the values of a float signal. */
+inline void minMax(const float *signal, size_t valueNb, float &min, float &max)
+{
+    scalar::minMax(signal, valueNb, min, max);
+}
+
+/** @return the number of consecutive values of different signs, 0 being positive. */
+inline size_t zeroCrossings(const float *signal, size_t valueNb)
+{
+    return scalar::zeroCrossings(signal, valueNb);
+}
+
+/** @return the number of values whose absolute value is at least clipLevel > 0. */
+inline size_t clippedValues(const float *signal, size_t valueNb, float clipLevel)
+{
+    return scalar::clippedValues(signal, valueNb, clipLevel);
+}
+
+/** Euclidean division rounding toward minus infinity: numerator = quotient * denominator + rest
+ *  with 0 <= rest < denominator. */
+inline void floorDivide(int64_t numerator, int64_t denominator, int64_t &quotient, int64_t &rest)
+{
+    quotient = numerator / denominator;
+    rest = numerator % denominator;
+    if (rest < 0) {
+        quotient--;
+        rest += denominator;
+    }
+}
+
+/** Second order moments of a signal type.
+ *
+ *  8 and 16 bits signals moments are derived from exact integer sums. To avoid
+ *  cancellation, the sums are recentred on their exact mean before being
+ *  converted to double, thus a constant signal always has a null variance.
+ */
+template <class T>
+struct Moments
+{
+    /** @return sum((signal(t) - mean)^2) */
+    static double centredSquares(double mean, const T *signal, size_t valueNb)
+    {
+        return centredSquares(mean, valueNb, sum(signal, valueNb), sumOfSquares(signal, valueNb));
+    }
+
+    /** @return sum((signal(t) - mean)^2) from the signal sums of values and squares. */
+    static double centredSquares(double mean, int64_t n, int64_t sum1, int64_t sum2)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        // sum1 = quotient * n + rest, thus sum2 - sum1^2 / n is:
+        int64_t quotient, rest;
+        floorDivide(sum1, n, quotient, rest);
+        double centred = double(sum2 - quotient * quotient * n - 2 * quotient * rest) -
+                         double(rest) * rest / n;
+
+        // Offset between the given mean and the exact one
+        double offset = (mean - quotient) - double(rest) / n;
+        return centred + n * offset * offset;
+    }
+
+    /** @return sum((A(t) - meanA) * (B(t) - meanB)) */
+    static double centredProducts(double meanA, double meanB,
+                                  const T *signalA, const T *signalB, size_t valueNb)
+    {
+        if (valueNb == 0) {
+            return 0;
+        }
+        int64_t n = valueNb;
+        int64_t sumA, sumB, sumAB;
+        productSums(signalA, signalB, valueNb, sumA, sumB, sumAB);
+
+        // sumA = quotientA * n + restA, thus sumAB - sumA * sumB / n is:
+        int64_t quotientA, restA, quotientB, restB;
+        floorDivide(sumA, n, quotientA, restA);
+        floorDivide(sumB, n, quotientB, restB);
+        double centred = double(sumAB - quotientA * sumB) - double(restA) * sumB / n;
+
+        // Offsets between the given means and the exact ones
+        double offsetA = (meanA - quotientA) - double(restA) / n;
+        double offsetB = (meanB - quotientB) - double(restB) / n;
+        return centred + n * offsetA * offsetB;
+    }
+};
+
+/** 32 bits and float squares do not fit in 64 bits integers, compute in double. */
+template <class T>
+struct CentredMoments
+{
+    static double centredSquares(double mean, const T *signal, size_t valueNb)
+    {
+        return centredSumOfSquares(mean, signal, valueNb);
+    }
+
+    static double centredProducts(double meanA, double meanB,
+                                  const T *signalA, const T *signalB, size_t valueNb)
+    {
+        return centredSumOfProducts(meanA, meanB, signalA, signalB, valueNb);
+    }
+};
+
+template <>
+struct Moments<int32_t> : CentredMoments<int32_t> {};
+
+template <>
+struct Moments<float> : CentredMoments<float> {};
+
+/** Accumulate the first and second order moments of a signal block by block.
+ *
+ *  8 and 16 bits signals moments are accumulated exactly.
+ */
+template <class T>
+class MomentsAccumulator
+{
+public:
+    MomentsAccumulator() : mValueNb(0), mSum(0), mSumOfSquares(0) {}
+
+    void add(const T *block, size_t valueNb)
+    {
+        mValueNb += valueNb;
+        mSum += sum(block, valueNb);
+        mSumOfSquares += sumOfSquares(block, valueNb);
+    }
+
+    double mean() const { return double(mSum) / mValueNb; }
+
+    /** @return the sum of the squared deviations to the mean. */
+    double centredSquares() const
+    {
+        return Moments<T>::centredSquares(mean(), mValueNb, mSum, mSumOfSquares);
+    }
+
+    double energy() const { return double(mSumOfSquares); }
+
+private:
+    int64_t mValueNb;
+    int64_t mSum;
+    int64_t mSumOfSquares;
+};
+
+/** 32 bits and float signals blocks are centred on their own mean, then merged
+ *  with the pairwise update of Chan et al. (a generalization of Welford algorithm).
+ *
+ *  @tparam Sum the type of the sum of the values: exact for 32 bits signals.
+ */
+template <class T, class Sum>
+class CentredMomentsAccumulator
+{
+public:
+    CentredMomentsAccumulator()
+        : mValueNb(0), mSum(0), mMean(0), mCentredSquares(0), mEnergy(0) {}
+
+    void add(const T *block, size_t valueNb)
+    {
+        if (valueNb == 0) {
+            return;
+        }
+        Sum blockSum = sum(block, valueNb);
+        double blockMean = double(blockSum) / valueNb;
+        double blockCentredSquares = centredSumOfSquares(blockMean, block, valueNb);
+
+        double totalNb = double(mValueNb) + valueNb;
+        double delta = blockMean - mMean;
+        mMean += delta * valueNb / totalNb;
+        mCentredSquares += blockCentredSquares + delta * delta * mValueNb * valueNb / totalNb;
+        mEnergy += blockCentredSquares + valueNb * blockMean * blockMean;
+        mSum += blockSum;
+        mValueNb += valueNb;
+    }
+
+    /** Computed from the sum to match SignalProcessing::mean. */
+    double mean() const { return double(mSum) / mValueNb; }
+
+    double centredSquares() const { return mCentredSquares; }
+
+    double energy() const { return mEnergy; }
+
+private:
+    int64_t mValueNb;
+    Sum mSum;
+    double mMean;
+    double mCentredSquares;
+    double mEnergy;
+};
+
+template <>
+class MomentsAccumulator<int32_t> : public CentredMomentsAccumulator<int32_t, int64_t> {};
+
+template <>
+class MomentsAccumulator<float> : public CentredMomentsAccumulator<float, double> {};
+
+}
+}
+}
+}
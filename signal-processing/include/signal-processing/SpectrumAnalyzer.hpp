@@ -0,0 +1,375 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "signal-processing/SignalProcessing.hpp"
+#include "signal-processing/Fft.hpp"
+#include <AudioNonCopyable.hpp>
+#include <AudioUtilitiesAssert.hpp>
+#include <algorithm>
+#include <complex>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Spectral measures of signals, averaged with the Welch method.
+ *
+ *  Signals are cut in segments of a given size overlapped by half, each
+ *  segment is windowed and transformed, then the segment spectra are averaged.
+ *  Values after the last complete segment are ignored.
+ *
+ *  The transform, the window and all the working memory are computed at
+ *  construction: an analyzer is meant to be reused for all the captures of
+ *  a test campaign. Measures only allocate to size their output the first time.
+ *  An analyzer must not be used by several threads at the same time.
+ *
+ *  @tparam T the type of the array used to carry the signal.
+ */
+template <class T>
+class SpectrumAnalyzer : private NonCopyable
+{
+public:
+    typedef typename SignalProcessing<T>::Result Result;
+    typedef RealFft::Complex Complex;
+
+    /** Segment windows. Wider main lobes leak less to far bins. */
+    enum Window
+    {
+        Rectangular,
+        Hann,
+        /** 4 terms Blackman-Harris, -92 dB side lobes. */
+        BlackmanHarris
+    };
+
+    /** Distortion and noise of a sinusoid. */
+    struct Distortion
+    {
+        /** Frequency of the fundamental, in Hz. */
+        double fundamental;
+        /** Powers in signal unit squared. DC is excluded from all of them. */
+        double signalPower;
+        double harmonicPower;
+        double noisePower;
+        /** Harmonics to signal ratio, in dB. */
+        double thd;
+        /** Harmonics and noise to signal ratio, in dB. */
+        double thdN;
+        /** Signal to noise (harmonics excluded) ratio, in dB. */
+        double snr;
+    };
+
+    /**
+     *  @param[in] segmentSize number of values of the segments, must be a power of two.
+     *                         The frequency resolution is sampleRate / segmentSize.
+     *  @param[in] sampleRate of the signals, in Hz.
+     *  @param[in] window applied to the segments.
+     */
+    SpectrumAnalyzer(size_t segmentSize, double sampleRate, Window window = Hann);
+
+    /** @return the number of frequency bins: segmentSize / 2 + 1. */
+    size_t getBinNb() const { return mFft.getSpectrumSize(); }
+
+    /** @return the frequency of a bin, in Hz. */
+    double getBinFrequency(size_t bin) const { return bin * mBinWidth; }
+
+    /** One sided power spectral density.
+     *
+     *  @param[out] psd getBinNb() densities, in signal unit squared per Hz: the
+     *                  power of a band is the sum of its bins times the bin width.
+     *  @return NotEnoughData if the signal is shorter than a segment.
+     */
+    Result powerSpectrum(const T *signal, size_t valueNb, std::vector<double> &psd);
+
+    /** Measure the distortion of a sinusoid, the strongest component of the signal.
+     *
+     *  The fundamental, each harmonic and DC are the bins within the main lobe
+     *  of the window around their frequency, all the other bins are noise.
+     *
+     *  @param[in] maxHarmonic last harmonic rank, harmonics above Nyquist are ignored.
+     *  @return NotEnoughData if the signal is shorter than a segment,
+     *          ConstSignal if the signal has no power outside of DC.
+     */
+    Result distortion(const T *signal, size_t valueNb, Distortion &result,
+                      size_t maxHarmonic = 10);
+
+    /** Frequency response from a reference signal to its capture (H1 estimator).
+     *
+     *  The signals must be aligned, a residual delay only rotates the phases.
+     *
+     *  @param[out] response getBinNb() complex gains, null where the reference has no power.
+     *  @param[out] coherence getBinNb() ratios within [0, 1] of the capture power
+     *                        linearly explained by the reference.
+     *  @return NotEnoughData if the signals are shorter than a segment,
+     *          ConstSignal if the reference has no power.
+     */
+    Result frequencyResponse(const T *reference, const T *capture, size_t valueNb,
+                             std::vector<Complex> &response, std::vector<double> &coherence);
+
+private:
+    /** Classification of the bins by distortion. */
+    enum BinKind
+    {
+        NoiseBin,
+        HarmonicBin,
+        FundamentalBin,
+        DcBin
+    };
+
+    /** @return the number of segments of a signal, 0 if it is shorter than a segment. */
+    size_t getSegmentNb(size_t valueNb) const;
+
+    /** Window a segment and transform it in place in spectrum. */
+    void transformSegment(const T *segment, Complex *spectrum) const;
+
+    /** Classify the bins within the main lobe around a bin. */
+    void markLobe(size_t centre, BinKind kind);
+
+    const size_t mSegmentSize;
+    const double mBinWidth;
+
+    /** Bins on each side of a tone holding most of its power. */
+    size_t mLobeBinNb;
+
+    RealFft mFft;
+    std::vector<double> mWindow;
+    /** sum(window^2) */
+    double mWindowPower;
+
+    std::vector<Complex> mSpectrumA;
+    std::vector<Complex> mSpectrumB;
+    std::vector<double> mPowersA;
+    std::vector<double> mPowersB;
+    std::vector<BinKind> mBinKinds;
+};
+
+template <class T>
+SpectrumAnalyzer<T>::SpectrumAnalyzer(size_t segmentSize, double sampleRate, Window window)
+    : mSegmentSize(segmentSize), mBinWidth(sampleRate / segmentSize), mLobeBinNb(0),
+      mFft(segmentSize), mWindow(segmentSize), mWindowPower(0),
+      mSpectrumA(mFft.getSpectrumSize()), mSpectrumB(mFft.getSpectrumSize()),
+      mPowersA(mFft.getSpectrumSize()), mPowersB(mFft.getSpectrumSize()),
+      mBinKinds(mFft.getSpectrumSize())
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    AUDIOUTILITIES_ASSERT(sampleRate > 0, "Invalid sample rate " << sampleRate);
+
+    // Periodic windows, their main lobe being a whole number of bins
+    for (size_t i = 0; i < segmentSize; i++) {
+        double phase = 2 * M_PI * i / segmentSize;
+        switch (window) {
+        case Rectangular:
+            mWindow[i] = 1;
+            break;
+        case Hann:
+            mWindow[i] = 0.5 - 0.5 * cos(phase);
+            break;
+        case BlackmanHarris:
+            mWindow[i] = 0.35875 - 0.48829 * cos(phase) + 0.14128 * cos(2 * phase) -
+                         0.01168 * cos(3 * phase);
+            break;
+        }
+        mWindowPower += mWindow[i] * mWindow[i];
+    }
+    // Half main lobe width plus one bin for the tones between two bins
+    switch (window) {
+    case Rectangular:
+        mLobeBinNb = 2;
+        break;
+    case Hann:
+        mLobeBinNb = 3;
+        break;
+    case BlackmanHarris:
+        mLobeBinNb = 5;
+        break;
+    }
+}
+
+template <class T>
+size_t SpectrumAnalyzer<T>::getSegmentNb(size_t valueNb) const
+{
+    if (valueNb < mSegmentSize) {
+        return 0;
+    }
+    return (valueNb - mSegmentSize) / (mSegmentSize / 2) + 1;
+}
+
+template <class T>
+void SpectrumAnalyzer<T>::transformSegment(const T *segment, Complex *spectrum) const
+{
+    double *windowed = reinterpret_cast<double *>(spectrum);
+    for (size_t i = 0; i < mSegmentSize; i++) {
+        windowed[i] = segment[i] * mWindow[i];
+    }
+    mFft.forward(windowed, spectrum);
+}
+
+template <class T>
+typename SpectrumAnalyzer<T>::Result SpectrumAnalyzer<T>::powerSpectrum(
+    const T *signal, size_t valueNb, std::vector<double> &psd)
+{
+    size_t segmentNb = getSegmentNb(valueNb);
+    if (segmentNb == 0) {
+        return Result(SignalProcessing<T>::NotEnoughData)
+               << valueNb << " values for segments of " << mSegmentSize;
+    }
+
+    const size_t binNb = getBinNb();
+    psd.assign(binNb, 0);
+    for (size_t segment = 0; segment < segmentNb; segment++) {
+        transformSegment(signal + segment * (mSegmentSize / 2), &mSpectrumA[0]);
+        for (size_t bin = 0; bin < binNb; bin++) {
+            psd[bin] += std::norm(mSpectrumA[bin]);
+        }
+    }
+
+    // Negative frequencies are folded on the positive ones, except DC and Nyquist
+    double scale = 1 / (segmentNb * mWindowPower * mBinWidth * mSegmentSize);
+    for (size_t bin = 0; bin < binNb; bin++) {
+        bool folded = bin != 0 && bin != binNb - 1;
+        psd[bin] *= folded ? 2 * scale : scale;
+    }
+    return Result::success();
+}
+
+template <class T>
+void SpectrumAnalyzer<T>::markLobe(size_t centre, BinKind kind)
+{
+    size_t first = centre > mLobeBinNb ? centre - mLobeBinNb : 0;
+    size_t last = std::min(centre + mLobeBinNb, getBinNb() - 1);
+    for (size_t bin = first; bin <= last; bin++) {
+        mBinKinds[bin] = std::max(mBinKinds[bin], kind);
+    }
+}
+
+template <class T>
+typename SpectrumAnalyzer<T>::Result SpectrumAnalyzer<T>::distortion(
+    const T *signal, size_t valueNb, Distortion &result, size_t maxHarmonic)
+{
+    Result status = powerSpectrum(signal, valueNb, mPowersA);
+    if (status.isFailure()) {
+        return status;
+    }
+    const size_t binNb = getBinNb();
+
+    std::fill(mBinKinds.begin(), mBinKinds.end(), NoiseBin);
+    markLobe(0, DcBin);
+
+    // The fundamental is the strongest bin outside of DC
+    size_t peak = 0;
+    for (size_t bin = 0; bin < binNb; bin++) {
+        if (mBinKinds[bin] != DcBin && (peak == 0 || mPowersA[bin] > mPowersA[peak])) {
+            peak = bin;
+        }
+    }
+    if (peak == 0 || mPowersA[peak] == 0) {
+        return Result(SignalProcessing<T>::ConstSignal);
+    }
+    markLobe(peak, FundamentalBin);
+
+    // Power weighted frequency of the fundamental lobe, finer than a bin
+    double lobePower = 0;
+    double lobeMoment = 0;
+    for (size_t bin = 0; bin < binNb; bin++) {
+        if (mBinKinds[bin] == FundamentalBin) {
+            lobePower += mPowersA[bin];
+            lobeMoment += mPowersA[bin] * bin;
+        }
+    }
+    double fundamentalBin = lobeMoment / lobePower;
+
+    for (size_t rank = 2; rank <= maxHarmonic; rank++) {
+        size_t harmonic = size_t(rank * fundamentalBin + 0.5);
+        if (harmonic >= binNb) {
+            break;
+        }
+        markLobe(harmonic, HarmonicBin);
+    }
+
+    double powers[DcBin + 1] = { 0, 0, 0, 0 };
+    for (size_t bin = 0; bin < binNb; bin++) {
+        powers[mBinKinds[bin]] += mPowersA[bin] * mBinWidth;
+    }
+
+    result.fundamental = fundamentalBin * mBinWidth;
+    result.signalPower = powers[FundamentalBin];
+    result.harmonicPower = powers[HarmonicBin];
+    result.noisePower = powers[NoiseBin];
+    result.thd = 10 * log10(result.harmonicPower / result.signalPower);
+    result.thdN = 10 * log10((result.harmonicPower + result.noisePower) / result.signalPower);
+    result.snr = 10 * log10(result.signalPower / result.noisePower);
+    return Result::success();
+}
+
+template <class T>
+typename SpectrumAnalyzer<T>::Result SpectrumAnalyzer<T>::frequencyResponse(
+    const T *reference, const T *capture, size_t valueNb,
+    std::vector<Complex> &response, std::vector<double> &coherence)
+{
+    size_t segmentNb = getSegmentNb(valueNb);
+    if (segmentNb == 0) {
+        return Result(SignalProcessing<T>::NotEnoughData)
+               << valueNb << " values for segments of " << mSegmentSize;
+    }
+
+    // Scales cancel out in the ratios, spectra are averaged unnormalized
+    const size_t binNb = getBinNb();
+    response.assign(binNb, 0);
+    coherence.assign(binNb, 0);
+    std::fill(mPowersA.begin(), mPowersA.end(), 0);
+    std::fill(mPowersB.begin(), mPowersB.end(), 0);
+    for (size_t segment = 0; segment < segmentNb; segment++) {
+        size_t start = segment * (mSegmentSize / 2);
+        transformSegment(reference + start, &mSpectrumA[0]);
+        transformSegment(capture + start, &mSpectrumB[0]);
+        for (size_t bin = 0; bin < binNb; bin++) {
+            mPowersA[bin] += std::norm(mSpectrumA[bin]);
+            mPowersB[bin] += std::norm(mSpectrumB[bin]);
+            response[bin] += std::conj(mSpectrumA[bin]) * mSpectrumB[bin];
+        }
+    }
+
+    bool referencePower = false;
+    for (size_t bin = 0; bin < binNb; bin++) {
+        if (mPowersA[bin] == 0) {
+            response[bin] = 0;
+            continue;
+        }
+        referencePower = true;
+        if (mPowersB[bin] != 0) {
+            coherence[bin] = std::norm(response[bin]) / (mPowersA[bin] * mPowersB[bin]);
+        }
+        response[bin] /= mPowersA[bin];
+    }
+    if (not referencePower) {
+        return Result(SignalProcessing<T>::ConstSignal) << "null reference";
+    }
+    return Result::success();
+}
+
+}
+}
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "signal-processing/CorrelationWorkspace.hpp"
+#include <AudioNonCopyable.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Cross-correlate two signals captured chunk by chunk.
+ *
+ *  Both signals are assumed to start at the same time. Chunks of each of
+ *  them can be pushed independently as they are captured. Every hopSize
+ *  values, the normalized cross correlation of the last windowSize values of
+ *  both signals can be estimated, for example to track the drift of the
+ *  delay over long captures.
+ *
+ *  Each estimate is a full recompute of its window with a
+ *  CorrelationWorkspace: no sum is carried from one window to the next, so
+ *  an estimate costs the same whatever hopSize. Hops much smaller than the
+ *  window redo most of the work of the previous estimate.
+ *
+ *  Memory is bounded: each signal is buffered in a preallocated buffer of
+ *  capacity values, pushes that do not fit fail. Neither pushes nor
+ *  estimates allocate memory.
+ *  Running statistics (mean, variance, min, max, energy) of each whole
+ *  signal are also maintained.
+ *
+ *  @tparam T the type of the array used to carry the signal.
+ */
+template <class T>
+class StreamingCorrelator : private NonCopyable
+{
+public:
+    typedef SignalProcessing<T> Processing;
+    typedef typename Processing::Result Result;
+    typedef typename Processing::CrossCorrelationResult CrossCorrelationResult;
+    typedef typename Processing::Statistics Statistics;
+
+    /**
+     *  @param[in] windowSize number of values of each signal correlated by an estimate.
+     *  @param[in] hopSize number of values between two consecutive estimates.
+     *  @param[in] minDelay minimum delay searched, @see SignalProcessing::cross_correlate.
+     *  @param[in] maxDelay maximum delay searched, @see SignalProcessing::cross_correlate.
+     *  @param[in] capacity maximum number of buffered values per signal, at least
+     *                      windowSize. 0 means windowSize + 4 * hopSize.
+     */
+    StreamingCorrelator(size_t windowSize, size_t hopSize,
+                        ssize_t minDelay, ssize_t maxDelay, size_t capacity = 0);
+
+    /** Append a chunk to the signal A.
+     *
+     *  @return BufferOverflow if the chunk does not fit in the buffer, in which
+     *          case nothing is appended. Estimates must be consumed to make room.
+     */
+    Result pushA(const T *chunk, size_t valueNb) { return mChannelA.push(chunk, valueNb); }
+
+    /** Append a chunk to the signal B. @see pushA */
+    Result pushB(const T *chunk, size_t valueNb) { return mChannelB.push(chunk, valueNb); }
+
+    /** @return true if both signals have enough values for the next estimate. */
+    bool isEstimateReady() const;
+
+    /** Correlate the next window and slide to the following one.
+     *
+     *  Must only be called if isEstimateReady().
+     *  The whole window is correlated again, @see StreamingCorrelator.
+     *  @return the result of SignalProcessing::cross_correlate on the window.
+     */
+    Result estimate(CrossCorrelationResult &result);
+
+    /** @return the index, in both signals, of the first value of the next window. */
+    uint64_t getWindowStart() const { return mWindowStart; }
+
+    /** @return the statistics of all the values pushed to signal A. */
+    Statistics getStatisticsA() const { return mChannelA.getStatistics(); }
+
+    /** @return the statistics of all the values pushed to signal B. */
+    Statistics getStatisticsB() const { return mChannelB.getStatistics(); }
+
+private:
+    /** Buffer of the values of a signal that are not yet consumed. */
+    class Channel
+    {
+    public:
+        explicit Channel(size_t capacity)
+            : mBuffer(capacity), mBegin(0), mEnd(0), mFirstIndex(0)
+        {
+            mStatistics.min = std::numeric_limits<T>::max();
+            mStatistics.max = details::lowest<T>();
+        }
+
+        Result push(const T *chunk, size_t valueNb)
+        {
+            if (mEnd - mBegin + valueNb > mBuffer.size()) {
+                return Result(Processing::BufferOverflow)
+                       << "pushing " << valueNb << " values while " << (mEnd - mBegin)
+                       << " are buffered out of " << mBuffer.size();
+            }
+            if (mEnd + valueNb > mBuffer.size()) {
+                // Move back the buffered values to the buffer start
+                memmove(&mBuffer[0], &mBuffer[mBegin], (mEnd - mBegin) * sizeof(T));
+                mEnd -= mBegin;
+                mBegin = 0;
+            }
+            std::copy(chunk, chunk + valueNb, mBuffer.begin() + mEnd);
+            mEnd += valueNb;
+
+            details::minMax(chunk, valueNb, mStatistics.min, mStatistics.max);
+            mMoments.add(chunk, valueNb);
+            return Result::success();
+        }
+
+        /** @return the index following the last pushed value. */
+        uint64_t getEndIndex() const { return mFirstIndex + mEnd - mBegin; }
+
+        /** @return the buffered value of a given index. */
+        const T *at(uint64_t index) const { return &mBuffer[mBegin + (index - mFirstIndex)]; }
+
+        /** Release the values before a given index. */
+        void discardUntil(uint64_t index)
+        {
+            size_t discardedNb = std::min<uint64_t>(index - mFirstIndex, mEnd - mBegin);
+            mBegin += discardedNb;
+            mFirstIndex += discardedNb;
+        }
+
+        Statistics getStatistics() const
+        {
+            Statistics statistics = mStatistics;
+            statistics.mean = mMoments.mean();
+            statistics.variance = mMoments.centredSquares();
+            statistics.energy = mMoments.energy();
+            return statistics;
+        }
+
+    private:
+        std::vector<T> mBuffer;
+        /** Buffered values are [mBegin, mEnd[ */
+        size_t mBegin;
+        size_t mEnd;
+        /** Index in the signal of the value at mBegin */
+        uint64_t mFirstIndex;
+
+        details::MomentsAccumulator<T> mMoments;
+        /** min and max, other statistics are computed from mMoments. */
+        Statistics mStatistics;
+    };
+
+    const size_t mWindowSize;
+    const size_t mHopSize;
+
+    CorrelationWorkspace<T> mWorkspace;
+
+    uint64_t mWindowStart;
+
+    Channel mChannelA;
+    Channel mChannelB;
+};
+
+template <class T>
+StreamingCorrelator<T>::StreamingCorrelator(size_t windowSize, size_t hopSize,
+                                            ssize_t minDelay, ssize_t maxDelay,
+                                            size_t capacity)
+    : mWindowSize(windowSize), mHopSize(hopSize),
+      mWorkspace(windowSize, minDelay, maxDelay),
+      mWindowStart(0),
+      mChannelA(capacity == 0 ? windowSize + 4 * hopSize : std::max(capacity, windowSize)),
+      mChannelB(capacity == 0 ? windowSize + 4 * hopSize : std::max(capacity, windowSize))
+{
+    AUDIOUTILITIES_ASSERT(windowSize > 0 && hopSize > 0, "Invalid streaming correlator window");
+}
+
+template <class T>
+bool StreamingCorrelator<T>::isEstimateReady() const
+{
+    uint64_t windowEnd = mWindowStart + mWindowSize;
+    return mChannelA.getEndIndex() >= windowEnd && mChannelB.getEndIndex() >= windowEnd;
+}
+
+template <class T>
+typename StreamingCorrelator<T>::Result StreamingCorrelator<T>::estimate(
+    CrossCorrelationResult &result)
+{
+    AUDIOUTILITIES_ASSERT(isEstimateReady(), "Not enough values to estimate the correlation");
+
+    Result status = mWorkspace.cross_correlate(mChannelA.at(mWindowStart),
+                                               mChannelB.at(mWindowStart), result);
+
+    mWindowStart += mHopSize;
+    mChannelA.discardUntil(mWindowStart);
+    mChannelB.discardUntil(mWindowStart);
+
+    return status;
+}
+
+}
+}
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "signal-processing/SignalProcessing.hpp"
+#include <AudioNonCopyable.hpp>
+#include <complex>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Measure the amplitude and phase of a set of tones with the Goertzel algorithm.
+ *
+ *  Each tone costs one multiply and two adds per value, which is much cheaper
+ *  than correlating against a reference tone. The signal can be pushed chunk
+ *  by chunk, measures are available at any time.
+ *
+ *  The Goertzel recursion is restarted every blockSize values, each block
+ *  result being rotated to the phase of the signal start, so that rounding
+ *  errors do not grow with the signal length.
+ *
+ *  No window is applied: tones are best measured over an integer number of
+ *  their periods, or over a large number of periods.
+ *
+ *  @tparam T the type of the array used to carry the signal.
+ */
+template <class T>
+class ToneDetector : private NonCopyable
+{
+public:
+    typedef typename SignalProcessing<T>::Result Result;
+
+    /** Measure of a tone. */
+    struct Tone
+    {
+        /** In Hz */
+        double frequency;
+        /** Amplitude of the sinusoid, in signal unit. */
+        double magnitude;
+        /** Phase of the cosine at the first value, in radians within [-pi, pi]. */
+        double phase;
+    };
+
+    /**
+     *  @param[in] frequencies the frequencies of the tones to detect, in Hz,
+     *                         within [0, sampleRate / 2].
+     *  @param[in] sampleRate of the signal, in Hz.
+     */
+    ToneDetector(const std::vector<double> &frequencies, double sampleRate);
+
+    /** Process the following values of the signal. */
+    void push(const T *chunk, size_t valueNb);
+
+    /** Measure the tones of all the values pushed since the last reset.
+     *
+     *  @param[out] tones one measure per frequency, in the construction order.
+     *  @return NotEnoughData if no value was pushed.
+     */
+    Result getTones(std::vector<Tone> &tones) const;
+
+    /** Forget all the values pushed. */
+    void reset();
+
+    /** @return the number of values pushed since the last reset. */
+    uint64_t getValueNb() const { return mValueNb; }
+
+    /** Measure tones on a whole signal. @see ToneDetector */
+    static Result detect(const T *signal, size_t valueNb,
+                         const std::vector<double> &frequencies, double sampleRate,
+                         std::vector<Tone> &tones);
+
+private:
+    typedef std::complex<double> Complex;
+
+    /** Number of values between two restarts of the Goertzel recursion. */
+    static const size_t blockSize = 4096;
+
+    /** State of the recursion of a tone. */
+    struct Filter
+    {
+        double frequency;
+        /** Normalized angular frequency, in radians per value. */
+        double omega;
+        /** 2 * cos(omega) */
+        double coefficient;
+        /** Last two outputs of the recursion in the current block. */
+        double s1;
+        double s2;
+        /** sum(x(n) * exp(-i * omega * n)) over the completed blocks. */
+        Complex sum;
+    };
+
+    /** Add the current block recursion results to the sums and restart it. */
+    void flushBlock();
+
+    std::vector<Filter> mFilters;
+    uint64_t mValueNb;
+    /** Index of the first value of the current block. */
+    uint64_t mBlockStart;
+};
+
+template <class T>
+ToneDetector<T>::ToneDetector(const std::vector<double> &frequencies, double sampleRate)
+    : mFilters(frequencies.size()), mValueNb(0), mBlockStart(0)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+
+    AUDIOUTILITIES_ASSERT(sampleRate > 0, "Invalid sample rate " << sampleRate);
+    for (size_t i = 0; i < frequencies.size(); i++) {
+        AUDIOUTILITIES_ASSERT(frequencies[i] >= 0 && frequencies[i] <= sampleRate / 2,
+                              "Tone frequency out of [0, Nyquist]: " << frequencies[i]);
+        mFilters[i].frequency = frequencies[i];
+        mFilters[i].omega = 2 * M_PI * frequencies[i] / sampleRate;
+        mFilters[i].coefficient = 2 * cos(mFilters[i].omega);
+    }
+    reset();
+}
+
+template <class T>
+void ToneDetector<T>::reset()
+{
+    for (size_t i = 0; i < mFilters.size(); i++) {
+        mFilters[i].s1 = mFilters[i].s2 = 0;
+        mFilters[i].sum = 0;
+    }
+    mValueNb = 0;
+    mBlockStart = 0;
+}
+
+template <class T>
+void ToneDetector<T>::push(const T *chunk, size_t valueNb)
+{
+    while (valueNb > 0) {
+        size_t blockValueNb = std::min<size_t>(valueNb, mBlockStart + blockSize - mValueNb);
+
+        // Tone by tone, the values of the chunk stay in cache
+        for (size_t i = 0; i < mFilters.size(); i++) {
+            Filter &filter = mFilters[i];
+            double s1 = filter.s1;
+            double s2 = filter.s2;
+            for (size_t n = 0; n < blockValueNb; n++) {
+                double s0 = chunk[n] + filter.coefficient * s1 - s2;
+                s2 = s1;
+                s1 = s0;
+            }
+            filter.s1 = s1;
+            filter.s2 = s2;
+        }
+
+        chunk += blockValueNb;
+        valueNb -= blockValueNb;
+        mValueNb += blockValueNb;
+        if (mValueNb == mBlockStart + blockSize) {
+            flushBlock();
+        }
+    }
+}
+
+template <class T>
+void ToneDetector<T>::flushBlock()
+{
+    uint64_t blockValueNb = mValueNb - mBlockStart;
+    if (blockValueNb == 0) {
+        return;
+    }
+    for (size_t i = 0; i < mFilters.size(); i++) {
+        Filter &filter = mFilters[i];
+        // s1 - exp(-i * omega) * s2 is exp(i * omega * (N - 1)) * sum over the block
+        // of x(n) * exp(-i * omega * n), n being relative to the block start.
+        Complex last = Complex(filter.s1, 0) - std::polar(filter.s2, -filter.omega);
+        double lastIndex = double(mBlockStart + blockValueNb - 1);
+        filter.sum += last * std::polar(1.0, -filter.omega * lastIndex);
+        filter.s1 = filter.s2 = 0;
+    }
+    mBlockStart = mValueNb;
+}
+
+template <class T>
+typename ToneDetector<T>::Result ToneDetector<T>::getTones(std::vector<Tone> &tones) const
+{
+    tones.resize(mFilters.size());
+    if (mValueNb == 0) {
+        return Result(SignalProcessing<T>::NotEnoughData) << "no value pushed";
+    }
+
+    // Fold the current block without altering the recursion state.
+    double lastIndex = double(mValueNb - 1);
+    for (size_t i = 0; i < mFilters.size(); i++) {
+        const Filter &filter = mFilters[i];
+        Complex last = Complex(filter.s1, 0) - std::polar(filter.s2, -filter.omega);
+        Complex sum = filter.sum;
+        if (mValueNb > mBlockStart) {
+            sum += last * std::polar(1.0, -filter.omega * lastIndex);
+        }
+
+        // A cosine of amplitude A contributes A / 2 * N to its positive frequency,
+        // except for the DC and Nyquist frequencies which are real.
+        bool real = filter.omega == 0 || filter.omega == M_PI;
+        tones[i].frequency = filter.frequency;
+        tones[i].magnitude = std::abs(sum) * (real ? 1 : 2) / mValueNb;
+        tones[i].phase = std::arg(sum);
+    }
+    return Result::success();
+}
+
+template <class T>
+typename ToneDetector<T>::Result ToneDetector<T>::detect(const T *signal, size_t valueNb,
+                                                         const std::vector<double> &frequencies,
+                                                         double sampleRate,
+                                                         std::vector<Tone> &tones)
+{
+    ToneDetector<T> detector(frequencies, sampleRate);
+    detector.push(signal, valueNb);
+    return detector.getTones(tones);
+}
+
+}
+}
+}
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "signal-processing/SignalProcessing.hpp"
+#include <result/Result.hpp>
+#include <utilities/FileMapper.hpp>
+#include <AudioNonCopyable.hpp>
+#include <AudioUtilitiesAssert.hpp>
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+namespace details
+{
+
+/** WAVE_FORMAT tags of the sample types that can be read in place. */
+template <class T>
+struct WavSampleFormat;
+
+template <>
+struct WavSampleFormat<int16_t>
+{
+    enum { tag = 0x0001 /* WAVE_FORMAT_PCM */ };
+};
+
+template <>
+struct WavSampleFormat<int32_t>
+{
+    enum { tag = 0x0001 /* WAVE_FORMAT_PCM */ };
+};
+
+template <>
+struct WavSampleFormat<float>
+{
+    enum { tag = 0x0003 /* WAVE_FORMAT_IEEE_FLOAT */ };
+};
+
+}
+
+/** Map a RIFF/WAVE file in memory and give access to its samples in place.
+ *
+ *  The header is parsed and validated, then the samples are read directly
+ *  from the mapping: no sample is ever copied, whatever the file size.
+ *  Each channel is exposed as a StridedSignal over the interleaved frames.
+ *
+ *  The data is either mapped whole, or through a window of frames sliding
+ *  along it, which bounds the virtual memory used: files of up to 4GB are
+ *  read that way even on 32 bits targets.
+ *
+ *      for (Result res = reader.mapWindow(frameNb, overlap); res.isSuccess();
+ *           res = reader.nextWindow()) {
+ *          process(reader.getChannel(0), reader.getFrameNb());
+ *      }
+ *
+ *  As samples are read in place, the data chunk must start at an offset
+ *  multiple of the sample size. Files where it does not, which is legal,
+ *  for example after a chunk whose padded size is 2 modulo 4 with 32 bits
+ *  samples, are rejected with UnsupportedFormat.
+ *
+ *  WAV files are little endian, as the supported targets.
+ *
+ *  @tparam T the sample type of the file: int16_t or int32_t for PCM files,
+ *            float for IEEE float files. 8 bits PCM samples are unsigned,
+ *            thus not supported.
+ */
+template <class T>
+class WavReader : private NonCopyable
+{
+public:
+    enum FailureCode
+    {
+        Success = 555,
+        Unknown,
+        MappingError,
+        InvalidFile,
+        UnsupportedFormat,
+        EndOfData
+    };
+
+    struct WavReaderStatus
+    {
+        typedef FailureCode Code;
+
+        /** Enum coding the failures that can occur in the class methods. */
+        const static Code success = Success;
+        const static Code defaultError = Unknown;
+
+        static std::string codeToString(const Code &code)
+        {
+            switch (code) {
+            case Success:
+                return "Success";
+            case Unknown:
+                return "Unknown error";
+            case MappingError:
+                return "Mapping error";
+            case InvalidFile:
+                return "Invalid WAV file";
+            case UnsupportedFormat:
+                return "Unsupported WAV format";
+            case EndOfData:
+                return "End of data";
+            }
+            /* Unreachable, prevents gcc to complain */
+            return "Invalid error (Unreachable)";
+        }
+    };
+
+    /** The type of the method returns. */
+    typedef result::Result<WavReaderStatus> Result;
+
+    /** @param[in] fileName the name of the file to read, must outlive the reader. */
+    explicit WavReader(const char *fileName);
+
+    /** Map the file and parse its header.
+     *
+     *  A data chunk longer than the file, as left by an interrupted recording,
+     *  is truncated to the complete frames of the file.
+     *
+     *  @return MappingError if the file can not be mapped, for example if it
+     *                       does not fit in the address space: use windows,
+     *          InvalidFile if it is not a RIFF/WAVE file,
+     *          UnsupportedFormat if its samples are not of type T or not aligned.
+     */
+    Result map();
+
+    /** Parse the header and map the first window of frames.
+     *
+     *  @param[in] windowFrameNb number of frames of the windows, the last
+     *                           window may be shorter.
+     *  @param[in] overlapFrameNb number of frames shared by two consecutive
+     *                            windows, less than windowFrameNb.
+     *  @return EndOfData if the data chunk is empty, other failures as map().
+     */
+    Result mapWindow(size_t windowFrameNb, size_t overlapFrameNb = 0);
+
+    /** Slide the window forward by windowFrameNb - overlapFrameNb frames.
+     *
+     *  Pointers and channels of the previous window are invalidated.
+     *  @return EndOfData if the current window was the last one, the current
+     *          window staying mapped.
+     */
+    Result nextWindow();
+
+    size_t getChannelNb() const { return mChannelNb; }
+
+    /** In Hz */
+    uint32_t getSampleRate() const { return mSampleRate; }
+
+    /** @return the number of values of each channel in the mapping: the whole
+     *          data, or the current window.
+     */
+    size_t getFrameNb() const { return mFrameNb; }
+
+    /** @return the index in the data of the first mapped frame. */
+    uint64_t getFirstFrame() const { return mFirstFrame; }
+
+    /** @return the number of frames of the whole data, once parsed. */
+    uint64_t getDataFrameNb() const { return mDataFrameNb; }
+
+    /** @return the interleaved frames, NULL if the file is not mapped. */
+    const T *getFrames() const { return mFrames; }
+
+    /** @return a view on a channel, valid as long as the mapping. */
+    StridedSignal<T> getChannel(size_t channel) const;
+
+private:
+    static uint16_t readLittleEndian16(const char *bytes);
+    static uint32_t readLittleEndian32(const char *bytes);
+
+    /** Validate the fmt chunk. */
+    Result parseFormat(const char *chunk, size_t chunkSize);
+
+    /** Walk the chunks, mapping one at a time, up to the data chunk. */
+    Result parseHeader();
+
+    /** Map the window starting at a frame of the data. */
+    Result mapFrames(uint64_t firstFrame);
+
+    FileMapper<char> mMapper;
+
+    size_t mChannelNb;
+    uint32_t mSampleRate;
+
+    /** Data chunk, in the file */
+    uint64_t mDataOffset;
+    uint64_t mDataFrameNb;
+
+    /** Window mode, the windows being mapped if mWindowFrameNb is not null */
+    size_t mWindowFrameNb;
+    size_t mWindowHopNb;
+
+    /** Mapped frames */
+    uint64_t mFirstFrame;
+    size_t mFrameNb;
+    const T *mFrames;
+};
+
+template <class T>
+WavReader<T>::WavReader(const char *fileName)
+    : mMapper(fileName), mChannelNb(0), mSampleRate(0), mDataOffset(0), mDataFrameNb(0),
+      mWindowFrameNb(0), mWindowHopNb(0), mFirstFrame(0), mFrameNb(0), mFrames(NULL)
+{
+    /* Check that processing with that type is allowed.
+     * If this fails, this means that this template was not intended to be used
+     * with this type, thus that the result is undefined. */
+    details::ProcessingAllowed<T>();
+}
+
+template <class T>
+uint16_t WavReader<T>::readLittleEndian16(const char *bytes)
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(bytes);
+    return uint16_t(data[0] | (data[1] << 8));
+}
+
+template <class T>
+uint32_t WavReader<T>::readLittleEndian32(const char *bytes)
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(bytes);
+    return uint32_t(data[0]) | (uint32_t(data[1]) << 8) |
+           (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+template <class T>
+typename WavReader<T>::Result WavReader<T>::parseFormat(const char *chunk, size_t chunkSize)
+{
+    /* WAVEFORMAT: tag, channels, sample rate, byte rate, block align, bits per sample */
+    if (chunkSize < 16) {
+        return Result(InvalidFile) << "fmt chunk of " << chunkSize << " bytes";
+    }
+    uint16_t tag = readLittleEndian16(chunk);
+    uint16_t channelNb = readLittleEndian16(chunk + 2);
+    uint32_t sampleRate = readLittleEndian32(chunk + 4);
+    uint16_t blockAlign = readLittleEndian16(chunk + 12);
+    uint16_t bitsPerSample = readLittleEndian16(chunk + 14);
+
+    /* WAVE_FORMAT_EXTENSIBLE: the tag is the first field of the sub format GUID */
+    if (tag == 0xFFFE) {
+        if (chunkSize < 40) {
+            return Result(InvalidFile) << "extensible fmt chunk of " << chunkSize << " bytes";
+        }
+        tag = readLittleEndian16(chunk + 24);
+    }
+
+    if (tag != details::WavSampleFormat<T>::tag || bitsPerSample != 8 * sizeof(T)) {
+        return Result(UnsupportedFormat) << "format " << tag << " of " << bitsPerSample
+                                         << " bits samples, expected format "
+                                         << details::WavSampleFormat<T>::tag << " of "
+                                         << 8 * sizeof(T) << " bits";
+    }
+    if (channelNb == 0 || blockAlign != channelNb * sizeof(T)) {
+        return Result(InvalidFile) << channelNb << " channels in blocks of "
+                                   << blockAlign << " bytes";
+    }
+    mChannelNb = channelNb;
+    mSampleRate = sampleRate;
+    return Result::success();
+}
+
+template <class T>
+typename WavReader<T>::Result WavReader<T>::parseHeader()
+{
+    /* Chunk header and the longest fmt chunk parsed */
+    static const size_t chunkWindowSize = 8 + 40;
+
+    FileMapper<char>::Result fileMapping = mMapper.mapWindow(chunkWindowSize);
+    if (fileMapping.getErrorCode() == FileMapper<char>::EndOfFile) {
+        return Result(InvalidFile) << "empty file";
+    }
+    Result mapping(fileMapping, MappingError);
+    if (mapping.isFailure()) {
+        return mapping;
+    }
+    const uint64_t fileSize = mMapper.getFileValueNb();
+    const char *header = mMapper.getMappedFile();
+
+    if (fileSize < 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        return Result(InvalidFile) << "no RIFF/WAVE header";
+    }
+
+    bool formatFound = false;
+    uint64_t offset = 12;
+    while (offset + 8 <= fileSize) {
+        Result chunkMapping(mMapper.mapWindow(chunkWindowSize, 0, offset), MappingError);
+        if (chunkMapping.isFailure()) {
+            return chunkMapping;
+        }
+        const char *chunkHeader = mMapper.getMappedFile();
+        uint32_t chunkSize = readLittleEndian32(chunkHeader + 4);
+        uint64_t availableSize = fileSize - offset - 8;
+
+        if (memcmp(chunkHeader, "fmt ", 4) == 0) {
+            if (chunkSize > availableSize) {
+                return Result(InvalidFile) << "truncated fmt chunk";
+            }
+            /* Only the beginning of the chunk is mapped, the rest being ignored */
+            Result format = parseFormat(chunkHeader + 8,
+                                        std::min<size_t>(chunkSize, chunkWindowSize - 8));
+            if (format.isFailure()) {
+                return format;
+            }
+            formatFound = true;
+        } else if (memcmp(chunkHeader, "data", 4) == 0) {
+            if (not formatFound) {
+                return Result(InvalidFile) << "data chunk before the fmt chunk";
+            }
+            /* Mappings start at a page boundary, offset alignment is sample alignment */
+            if ((offset + 8) % sizeof(T) != 0) {
+                return Result(UnsupportedFormat) << "samples at offset " << offset + 8
+                                                 << " are not aligned";
+            }
+            mDataOffset = offset + 8;
+            mDataFrameNb = std::min<uint64_t>(chunkSize, availableSize) / (mChannelNb * sizeof(T));
+            return Result::success();
+        }
+        if (chunkSize >= availableSize) {
+            break;
+        }
+        /* Chunks are padded to an even size */
+        offset += 8 + uint64_t(chunkSize) + (chunkSize & 1);
+    }
+    return Result(InvalidFile) << (formatFound ? "no data chunk" : "no fmt chunk");
+}
+
+template <class T>
+typename WavReader<T>::Result WavReader<T>::map()
+{
+    mFrames = NULL;
+    Result header = parseHeader();
+    if (header.isFailure()) {
+        return header;
+    }
+    Result mapping(mMapper.map(), MappingError);
+    if (mapping.isFailure()) {
+        return mapping;
+    }
+    mWindowFrameNb = 0;
+    mFirstFrame = 0;
+    mFrameNb = mDataFrameNb;
+    mFrames = reinterpret_cast<const T *>(mMapper.getMappedFile() + mDataOffset);
+    return Result::success();
+}
+
+template <class T>
+typename WavReader<T>::Result WavReader<T>::mapWindow(size_t windowFrameNb,
+                                                      size_t overlapFrameNb)
+{
+    mFrames = NULL;
+    Result header = parseHeader();
+    if (header.isFailure()) {
+        return header;
+    }
+    if (windowFrameNb == 0 || overlapFrameNb >= windowFrameNb ||
+        windowFrameNb > std::numeric_limits<size_t>::max() / (mChannelNb * sizeof(T))) {
+        return Result(Unknown) << "invalid window of " << windowFrameNb
+                               << " frames overlapping by " << overlapFrameNb;
+    }
+    if (mDataFrameNb == 0) {
+        return Result(EndOfData) << "no frame";
+    }
+    mWindowFrameNb = windowFrameNb;
+    mWindowHopNb = windowFrameNb - overlapFrameNb;
+
+    return mapFrames(0);
+}
+
+template <class T>
+typename WavReader<T>::Result WavReader<T>::nextWindow()
+{
+    if (mFrames == NULL || mWindowFrameNb == 0) {
+        return Result(Unknown) << "no window mapped";
+    }
+    if (mFirstFrame + mFrameNb >= mDataFrameNb) {
+        return Result(EndOfData);
+    }
+    return mapFrames(mFirstFrame + mWindowHopNb);
+}
+
+template <class T>
+typename WavReader<T>::Result WavReader<T>::mapFrames(uint64_t firstFrame)
+{
+    const size_t frameSize = mChannelNb * sizeof(T);
+    size_t frameNb = std::min<uint64_t>(mWindowFrameNb, mDataFrameNb - firstFrame);
+
+    Result mapping(mMapper.mapWindow(frameNb * frameSize, 0, mDataOffset + firstFrame * frameSize),
+                   MappingError);
+    if (mapping.isFailure()) {
+        return mapping;
+    }
+    mFirstFrame = firstFrame;
+    mFrameNb = frameNb;
+    mFrames = reinterpret_cast<const T *>(mMapper.getMappedFile());
+    return Result::success();
+}
+
+template <class T>
+StridedSignal<T> WavReader<T>::getChannel(size_t channel) const
+{
+    AUDIOUTILITIES_ASSERT(mFrames != NULL, "WAV file not mapped");
+    return StridedSignal<T>(mFrames, mChannelNb, channel);
+}
+
+}
+}
+}
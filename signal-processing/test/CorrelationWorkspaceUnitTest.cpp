@@ -0,0 +1,155 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/CorrelationWorkspace.hpp"
+#include "TypedTest.hpp"
+#include "TestSignal.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+
+/** Heap allocations made while allocationCounting is set.
+ *
+ *  operator new and the matching operator delete are replaced together, the
+ *  array forms calling them by default.
+ */
+static bool allocationCounting = false;
+static size_t allocationNb = 0;
+
+/* Not inlined: once inlined, the compiler would see free() releasing memory
+ * of operator new and report a mismatch. */
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    if (allocationCounting) {
+        allocationNb++;
+    }
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+__attribute__((noinline)) void operator delete(void *memory) throw()
+{
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) throw()
+{
+    free(memory);
+}
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST4 (int8_t, int16_t, int32_t, float) CorrelationWorkspaceTestTypes;
+
+template <class T>
+struct WorkspaceCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 2000;
+        const ssize_t realDelays[] = { 17, -230 };
+
+        CorrelationWorkspace<T> fftWorkspace(valueNb, -300, 300);
+        CorrelationWorkspace<T> directWorkspace(valueNb, 0, 20);
+
+        for (size_t d = 0; d < sizeof(realDelays) / sizeof(realDelays[0]); d++) {
+            std::vector<T> valsA;
+            std::vector<T> valsB;
+            TestSignal<T>::noise(valsA, valueNb, 11 + d);
+            TestSignal<T>::delay(valsA, valsB, realDelays[d]);
+
+            typename SignalProcessing<T>::CrossCorrelationResult expectedCC;
+            typename SignalProcessing<T>::CrossCorrelationResult workspaceCC;
+
+            SignalProcessing<T>::cross_correlate(&valsA[0], &valsB[0], valueNb,
+                                                 expectedCC, -300, 300);
+            ASSERT_TRUE(fftWorkspace.cross_correlate(&valsA[0], &valsB[0],
+                                                     workspaceCC).isSuccess());
+            EXPECT_EQ(realDelays[d], workspaceCC.delay);
+            EXPECT_EQ(expectedCC.delay, workspaceCC.delay);
+            EXPECT_EQ(expectedCC.coefficient, workspaceCC.coefficient);
+
+            SignalProcessing<T>::cross_correlate_phat(&valsA[0], &valsB[0], valueNb,
+                                                      expectedCC, -300, 300);
+            ASSERT_TRUE(fftWorkspace.cross_correlate_phat(&valsA[0], &valsB[0],
+                                                          workspaceCC).isSuccess());
+            EXPECT_EQ(expectedCC.delay, workspaceCC.delay);
+            EXPECT_EQ(expectedCC.coefficient, workspaceCC.coefficient);
+
+            SignalProcessing<T>::cross_correlate(&valsA[0], &valsB[0], valueNb,
+                                                 expectedCC, 0, 20);
+            ASSERT_TRUE(directWorkspace.cross_correlate(&valsA[0], &valsB[0],
+                                                        workspaceCC).isSuccess());
+            EXPECT_EQ(expectedCC.delay, workspaceCC.delay);
+            EXPECT_EQ(expectedCC.coefficient, workspaceCC.coefficient);
+        }
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(WorkspaceCrossCorrelationTest, CorrelationWorkspaceTestTypes);
+
+template <class T>
+struct WorkspaceAllocationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 1000;
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        std::vector<T> constVals(valueNb, 1);
+        TestSignal<T>::noise(valsA, valueNb, 21);
+        TestSignal<T>::delay(valsA, valsB, 5);
+
+        CorrelationWorkspace<T> workspace(valueNb, -100, 100);
+        typename SignalProcessing<T>::CrossCorrelationResult resultCC;
+
+        allocationNb = 0;
+        allocationCounting = true;
+        bool fftSuccess = workspace.cross_correlate_fft(&valsA[0], &valsB[0],
+                                                        resultCC).isSuccess();
+        bool phatSuccess = workspace.cross_correlate_phat(&valsA[0], &valsB[0],
+                                                          resultCC).isSuccess();
+        bool directSuccess = workspace.cross_correlate_direct(&valsA[0], &valsB[0],
+                                                              resultCC).isSuccess();
+        bool constFailure = workspace.cross_correlate_fft(&valsA[0], &constVals[0],
+                                                          resultCC).isFailure();
+        allocationCounting = false;
+
+        EXPECT_TRUE(fftSuccess);
+        EXPECT_TRUE(phatSuccess);
+        EXPECT_TRUE(directSuccess);
+        EXPECT_TRUE(constFailure);
+        EXPECT_EQ(0u, allocationNb);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(WorkspaceAllocationTest, CorrelationWorkspaceTestTypes);
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
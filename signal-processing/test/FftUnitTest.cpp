@@ -0,0 +1,93 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/Fft.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+TEST(RealFft, nextPowerOfTwo)
+{
+    EXPECT_EQ(2u, RealFft::nextPowerOfTwo(0));
+    EXPECT_EQ(2u, RealFft::nextPowerOfTwo(2));
+    EXPECT_EQ(4u, RealFft::nextPowerOfTwo(3));
+    EXPECT_EQ(1024u, RealFft::nextPowerOfTwo(1000));
+    EXPECT_EQ(1024u, RealFft::nextPowerOfTwo(1024));
+}
+
+TEST(RealFft, forwardMatchesDft)
+{
+    const size_t sizes[] = { 2, 4, 8, 64 };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s];
+        RealFft fft(size);
+        ASSERT_EQ(size / 2 + 1, fft.getSpectrumSize());
+
+        std::vector<double> input(size);
+        for (size_t i = 0; i < size; i++) {
+            input[i] = sin(0.3 * i * i) + 0.25 * i;
+        }
+        std::vector<RealFft::Complex> spectrum(fft.getSpectrumSize());
+        fft.forward(&input[0], &spectrum[0]);
+
+        for (size_t k = 0; k < spectrum.size(); k++) {
+            RealFft::Complex expected = 0;
+            for (size_t i = 0; i < size; i++) {
+                expected += input[i] * std::polar(1.0, -2 * M_PI * k * i / size);
+            }
+            EXPECT_NEAR(expected.real(), spectrum[k].real(), 1e-9)
+                << "size " << size << " bin " << k;
+            EXPECT_NEAR(expected.imag(), spectrum[k].imag(), 1e-9)
+                << "size " << size << " bin " << k;
+        }
+    }
+}
+
+TEST(RealFft, inverseRoundTrip)
+{
+    const size_t size = 4096;
+    RealFft fft(size);
+
+    std::vector<double> input(size);
+    for (size_t i = 0; i < size; i++) {
+        input[i] = cos(0.01 * i) * 1000 + (i % 7);
+    }
+    std::vector<RealFft::Complex> spectrum(fft.getSpectrumSize());
+    std::vector<double> output(size);
+
+    fft.forward(&input[0], &spectrum[0]);
+    fft.inverse(&spectrum[0], &output[0]);
+
+    for (size_t i = 0; i < size; i++) {
+        EXPECT_NEAR(input[i], output[i], 1e-9);
+    }
+}
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
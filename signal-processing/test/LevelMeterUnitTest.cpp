@@ -0,0 +1,144 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/LevelMeter.hpp"
+#include "TypedTest.hpp"
+#include "TestSignal.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST4 (int8_t, int16_t, int32_t, float) LevelMeterTestTypes;
+
+template <class T>
+struct BlockLevelsTest
+{
+    void operator()()
+    {
+        typedef typename LevelMeter<T>::Levels Levels;
+
+        // Square wave of amplitude 50 around 10, the last block is shorter
+        const size_t blockSize = 100;
+        const size_t valueNb = 250;
+        std::vector<T> signal(valueNb);
+        for (size_t i = 0; i < valueNb; i++) {
+            signal[i] = static_cast<T>(i % 2 ? -40 : 60);
+        }
+        // Clipped values in the second block, keeping the signs
+        const T clipLevel = 100;
+        signal[150] = clipLevel;
+        signal[151] = -clipLevel;
+
+        std::vector<Levels> levels;
+        LevelMeter<T>::measure(&signal[0], valueNb, blockSize, levels, clipLevel);
+        ASSERT_EQ(3u, levels.size());
+
+        EXPECT_FLOAT_EQ(10, levels[0].dcOffset);
+        EXPECT_FLOAT_EQ(sqrt(10 * 10 + 50 * 50), levels[0].rms);
+        EXPECT_FLOAT_EQ(60, levels[0].peak);
+        EXPECT_FLOAT_EQ(0.99f, levels[0].zeroCrossingRate);
+        EXPECT_EQ(0u, levels[0].clippedNb);
+
+        EXPECT_FLOAT_EQ(100, levels[1].peak);
+        EXPECT_EQ(2u, levels[1].clippedNb);
+        // Crossing from the previous block
+        EXPECT_FLOAT_EQ(1, levels[1].zeroCrossingRate);
+
+        EXPECT_FLOAT_EQ(10, levels[2].dcOffset);
+        EXPECT_EQ(0u, levels[2].clippedNb);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(BlockLevelsTest, LevelMeterTestTypes);
+
+template <class T>
+struct StreamingLevelsTest
+{
+    void operator()()
+    {
+        typedef typename LevelMeter<T>::Levels Levels;
+
+        // Blocks larger than the meter processing pieces, chunks across blocks
+        const size_t blockSize = 10000;
+        const size_t valueNb = 45000;
+        const T clipLevel = static_cast<T>(LevelMeter<T>::getFullScale() * 0.9);
+        std::vector<T> signal;
+        TestSignal<T>::noise(signal, valueNb, 7, LevelMeter<T>::getFullScale());
+
+        std::vector<Levels> expected;
+        LevelMeter<T>::measure(&signal[0], valueNb, blockSize, expected, clipLevel);
+        ASSERT_EQ(5u, expected.size());
+
+        LevelMeter<T> meter(blockSize, clipLevel);
+        std::vector<Levels> levels;
+        const size_t chunkSize = 3001;
+        for (size_t pushed = 0; pushed < valueNb; pushed += chunkSize) {
+            meter.push(&signal[0] + pushed, std::min(chunkSize, valueNb - pushed), levels);
+        }
+        EXPECT_EQ(4u, levels.size());
+        meter.flush(levels);
+        ASSERT_EQ(expected.size(), levels.size());
+
+        for (size_t block = 0; block < levels.size(); block++) {
+            size_t start = block * blockSize;
+            size_t end = std::min(start + blockSize, valueNb);
+
+            // Straightforward reference
+            double sum = 0;
+            double energy = 0;
+            double peak = 0;
+            size_t crossingNb = 0;
+            uint32_t clippedNb = 0;
+            for (size_t i = start; i < end; i++) {
+                sum += signal[i];
+                energy += double(signal[i]) * signal[i];
+                peak = std::max(peak, std::fabs(double(signal[i])));
+                crossingNb += i > 0 && (signal[i] < 0) != (signal[i - 1] < 0);
+                clippedNb += signal[i] >= clipLevel || signal[i] <= -clipLevel;
+            }
+            double n = end - start;
+
+            EXPECT_FLOAT_EQ(sum / n, levels[block].dcOffset);
+            EXPECT_FLOAT_EQ(sqrt(energy / n), levels[block].rms);
+            EXPECT_FLOAT_EQ(peak, levels[block].peak);
+            EXPECT_FLOAT_EQ(crossingNb / n, levels[block].zeroCrossingRate);
+            EXPECT_EQ(clippedNb, levels[block].clippedNb);
+            EXPECT_GT(clippedNb, 0u);
+
+            EXPECT_EQ(expected[block].rms, levels[block].rms);
+            EXPECT_EQ(expected[block].zeroCrossingRate, levels[block].zeroCrossingRate);
+        }
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(StreamingLevelsTest, LevelMeterTestTypes);
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
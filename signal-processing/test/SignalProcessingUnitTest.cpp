@@ -18,6 +18,7 @@
 
 #include "signal-processing/SignalProcessing.hpp"
 #include "TypedTest.hpp"
+#include "TestSignal.hpp"
 
 #include <utilities/TypeList.hpp>
 #include <gtest/gtest.h>
@@ -31,7 +32,7 @@ namespace signal_processing
 {
 
 // Available Type definitions
-typedef TYPELIST3 (int8_t, int16_t, int32_t) SignalProcessingTestTypes;
+typedef TYPELIST4 (int8_t, int16_t, int32_t, float) SignalProcessingTestTypes;
 
 
 /** Mean Tests */
@@ -161,6 +162,57 @@ struct NullVarianceTest
 
 AUDIOUTILITIES_TYPED_TEST(NullVarianceTest, SignalProcessingTestTypes);
 
+/** Statistics Tests */
+
+template <class T>
+struct StatisticsTest
+{
+    void operator()()
+    {
+        // Several statistics blocks
+        const size_t valueNb = 10007;
+        std::vector<T> vals;
+        TestSignal<T>::noise(vals, valueNb, 3, std::numeric_limits<T>::max() / 2);
+        vals[5000] = details::lowest<T>();
+        vals[9000] = std::numeric_limits<T>::max();
+
+        typename SignalProcessing<T>::Statistics statistics =
+            SignalProcessing<T>::statistics(&vals[0], valueNb);
+
+        double mean = SignalProcessing<T>::mean(&vals[0], valueNb);
+        double variance = SignalProcessing<T>::variance(mean, &vals[0], valueNb);
+        double energy = SignalProcessing<T>::variance(0, &vals[0], valueNb);
+
+        EXPECT_EQ(mean, statistics.mean);
+        EXPECT_NEAR(variance, statistics.variance, 1e-12 * variance);
+        EXPECT_NEAR(energy, statistics.energy, 1e-12 * energy);
+        EXPECT_EQ(details::lowest<T>(), statistics.min);
+        EXPECT_EQ(std::numeric_limits<T>::max(), statistics.max);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(StatisticsTest, SignalProcessingTestTypes);
+
+template <class T>
+struct ConstStatisticsTest
+{
+    void operator()()
+    {
+        std::vector<T> vals(5000, 14);
+
+        typename SignalProcessing<T>::Statistics statistics =
+            SignalProcessing<T>::statistics(&vals[0], vals.size());
+
+        EXPECT_EQ(14, statistics.mean);
+        EXPECT_EQ(0, statistics.variance);
+        EXPECT_EQ(14 * 14 * 5000, statistics.energy);
+        EXPECT_EQ(14, statistics.min);
+        EXPECT_EQ(14, statistics.max);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(ConstStatisticsTest, SignalProcessingTestTypes);
+
 /** Normalized Offset Product Tests */
 
 template <class T>
@@ -421,6 +473,421 @@ struct ConstSignalCrossCorrelationTest
 
 AUDIOUTILITIES_TYPED_TEST(ConstSignalCrossCorrelationTest, SignalProcessingTestTypes);
 
+template <class T>
+struct FftCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 4000;
+        const ssize_t realDelay = -123;
+
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        TestSignal<T>::noise(valsA, valueNb, 1);
+        TestSignal<T>::delay(valsA, valsB, realDelay);
+
+        typename SignalProcessing<T>::CrossCorrelationResult directCC = {
+            0, 0
+        };
+        typename SignalProcessing<T>::CrossCorrelationResult fftCC = {
+            0, 0
+        };
+
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_direct(
+                &valsA[0], &valsB[0], valueNb, directCC, -300, 300);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        result = SignalProcessing<T>::cross_correlate_fft(
+            &valsA[0], &valsB[0], valueNb, fftCC, -300, 300);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        EXPECT_EQ(realDelay, directCC.delay);
+        EXPECT_EQ(directCC.delay, fftCC.delay);
+        EXPECT_NEAR(directCC.coefficient, fftCC.coefficient, 1e-9);
+
+        // Delays out of the signal do not wrap around
+        result = SignalProcessing<T>::cross_correlate_fft(
+            &valsA[0], &valsB[0], valueNb, fftCC, realDelay - 10 * valueNb, realDelay);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(realDelay, fftCC.delay);
+        EXPECT_NEAR(directCC.coefficient, fftCC.coefficient, 1e-9);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(FftCrossCorrelationTest, SignalProcessingTestTypes);
+
+/** Interleave mono signals into frames. */
+template <class T>
+static void interleave(const std::vector<std::vector<T> > &channels, std::vector<T> &frames)
+{
+    size_t channelNb = channels.size();
+    frames.resize(channels[0].size() * channelNb);
+    for (size_t i = 0; i < channels[0].size(); i++) {
+        for (size_t channel = 0; channel < channelNb; channel++) {
+            frames[i * channelNb + channel] = channels[channel][i];
+        }
+    }
+}
+
+template <class T>
+struct StridedCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 3000;
+        const ssize_t realDelay = 37;
+
+        std::vector<std::vector<T> > channelsA(3);
+        std::vector<std::vector<T> > channelsB(2);
+        TestSignal<T>::noise(channelsA[0], valueNb, 2);
+        TestSignal<T>::noise(channelsA[1], valueNb, 3);
+        TestSignal<T>::noise(channelsA[2], valueNb, 4);
+        TestSignal<T>::delay(channelsA[1], channelsB[0], realDelay);
+        TestSignal<T>::noise(channelsB[1], valueNb, 5);
+
+        std::vector<T> framesA;
+        std::vector<T> framesB;
+        interleave(channelsA, framesA);
+        interleave(channelsB, framesB);
+
+        typename SignalProcessing<T>::CrossCorrelationResult monoCC = {
+            0, 0
+        };
+        typename SignalProcessing<T>::CrossCorrelationResult stridedCC = {
+            0, 0
+        };
+
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_fft(
+                &channelsA[1][0], &channelsB[0][0], valueNb, monoCC, -100, 100);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        result = SignalProcessing<T>::cross_correlate(
+            StridedSignal<T>(&framesA[0], 3, 1), StridedSignal<T>(&framesB[0], 2, 0),
+            valueNb, stridedCC, -100, 100);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        EXPECT_EQ(realDelay, monoCC.delay);
+        EXPECT_EQ(monoCC.delay, stridedCC.delay);
+        EXPECT_NEAR(monoCC.coefficient, stridedCC.coefficient, 1e-9);
+
+        // Contiguous views are correlated as plain signals
+        SignalProcessing<T>::cross_correlate(
+            &channelsA[1][0], &channelsB[0][0], valueNb, monoCC, -100, 100);
+        result = SignalProcessing<T>::cross_correlate(
+            StridedSignal<T>(&channelsA[1][0]), StridedSignal<T>(&channelsB[0][0]),
+            valueNb, stridedCC, -100, 100);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(monoCC.delay, stridedCC.delay);
+        EXPECT_EQ(monoCC.coefficient, stridedCC.coefficient);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(StridedCrossCorrelationTest, SignalProcessingTestTypes);
+
+template <class T>
+struct ChannelsCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 3000;
+
+        std::vector<std::vector<T> > channelsA(2);
+        std::vector<std::vector<T> > channelsB(3);
+        TestSignal<T>::noise(channelsA[0], valueNb, 6);
+        TestSignal<T>::noise(channelsA[1], valueNb, 7);
+        TestSignal<T>::delay(channelsA[1], channelsB[0], 5);
+        TestSignal<T>::delay(channelsA[0], channelsB[1], -20);
+        channelsB[2].assign(valueNb, 3);
+
+        std::vector<T> framesA;
+        std::vector<T> framesB;
+        interleave(channelsA, framesA);
+        interleave(channelsB, framesB);
+
+        std::vector<typename SignalProcessing<T>::CrossCorrelationResult> results;
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_channels(
+                &framesA[0], 2, &framesB[0], 3, valueNb, results, -50, 50);
+        EXPECT_EQ(SignalProcessing<T>::ConstSignal, result.getErrorCode());
+        ASSERT_EQ(6u, results.size());
+
+        EXPECT_EQ(-20, results[0 * 3 + 1].delay);
+        EXPECT_EQ(5, results[1 * 3 + 0].delay);
+
+        // Each pair matches its own correlation
+        for (size_t a = 0; a < 2; a++) {
+            for (size_t b = 0; b < 2; b++) {
+                typename SignalProcessing<T>::CrossCorrelationResult pairCC = {
+                    0, 0
+                };
+                result = SignalProcessing<T>::cross_correlate(
+                    StridedSignal<T>(&framesA[0], 2, a), StridedSignal<T>(&framesB[0], 3, b),
+                    valueNb, pairCC, -50, 50);
+                ASSERT_TRUE(result.isSuccess()) << result.format();
+                EXPECT_EQ(pairCC.delay, results[a * 3 + b].delay);
+                EXPECT_EQ(pairCC.coefficient, results[a * 3 + b].coefficient);
+            }
+            // Pairs with the constant channel are not correlated
+            EXPECT_EQ(0, results[a * 3 + 2].coefficient);
+            EXPECT_EQ(std::numeric_limits<ssize_t>::max(), results[a * 3 + 2].delay);
+        }
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(ChannelsCrossCorrelationTest, SignalProcessingTestTypes);
+
+template <class T>
+struct PhatCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 4000;
+        const ssize_t realDelay = 71;
+
+        // Strongly coloured signal: moving average of noise
+        std::vector<T> noise;
+        TestSignal<T>::noise(noise, valueNb, 9, std::numeric_limits<T>::max() / 2);
+        std::vector<T> valsA(valueNb);
+        for (size_t i = 0; i < valueNb; i++) {
+            double sum = 0;
+            for (size_t j = i; j < std::min(valueNb, i + 8); j++) {
+                sum += noise[j];
+            }
+            valsA[i] = static_cast<T>(sum / 8);
+        }
+        std::vector<T> valsB;
+        TestSignal<T>::delay(valsA, valsB, realDelay);
+
+        typename SignalProcessing<T>::CrossCorrelationResult phatCC = {
+            0, 0
+        };
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_phat(
+                &valsA[0], &valsB[0], valueNb, phatCC, -200, 200);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(realDelay, phatCC.delay);
+        EXPECT_GT(phatCC.coefficient, 0);
+        EXPECT_LE(phatCC.coefficient, 1);
+
+        // Restricted range
+        result = SignalProcessing<T>::cross_correlate_phat(
+            &valsA[0], &valsB[0], valueNb, phatCC, realDelay, realDelay);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(realDelay, phatCC.delay);
+
+        std::vector<T> constVals(valueNb, 5);
+        result = SignalProcessing<T>::cross_correlate_phat(
+            &valsA[0], &constVals[0], valueNb, phatCC, -200, 200);
+        EXPECT_EQ(SignalProcessing<T>::ConstSignal, result.getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(PhatCrossCorrelationTest, SignalProcessingTestTypes);
+
+template <class T>
+struct ParallelCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 3000;
+        const ssize_t realDelay = 57;
+
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        TestSignal<T>::noise(valsA, valueNb, 5);
+        TestSignal<T>::delay(valsA, valsB, realDelay);
+
+        typename SignalProcessing<T>::CrossCorrelationResult directCC = {
+            0, 0
+        };
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_direct(
+                &valsA[0], &valsB[0], valueNb, directCC, -100, 100);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(realDelay, directCC.delay);
+
+        const size_t threadNbs[] = { 0, 1, 2, 3, 8, 500 };
+        for (size_t t = 0; t < sizeof(threadNbs) / sizeof(threadNbs[0]); t++) {
+            typename SignalProcessing<T>::CrossCorrelationResult parallelCC = {
+                0, 0
+            };
+            result = SignalProcessing<T>::cross_correlate_parallel(
+                &valsA[0], &valsB[0], valueNb, parallelCC, -100, 100, threadNbs[t]);
+            ASSERT_TRUE(result.isSuccess()) << result.format();
+
+            // Same computation, same order: strictly identical
+            EXPECT_EQ(directCC.delay, parallelCC.delay) << threadNbs[t] << " threads";
+            EXPECT_EQ(directCC.coefficient, parallelCC.coefficient) << threadNbs[t] << " threads";
+        }
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(ParallelCrossCorrelationTest, SignalProcessingTestTypes);
+
+template <class T>
+struct CoarseToFineCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 8000;
+        const ssize_t realDelay = -437;
+        const size_t decimation = 4;
+        const size_t candidateNb = 3;
+
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        TestSignal<T>::noise(valsA, valueNb, 11);
+        TestSignal<T>::delay(valsA, valsB, realDelay);
+
+        typename SignalProcessing<T>::CrossCorrelationResult directCC = {
+            0, 0
+        };
+        typename SignalProcessing<T>::CrossCorrelationResult coarseCC = {
+            0, 0
+        };
+        std::vector<typename SignalProcessing<T>::CrossCorrelationResult> candidates;
+
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_direct(
+                &valsA[0], &valsB[0], valueNb, directCC, -1000, 1000);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        result = SignalProcessing<T>::cross_correlate_coarse_to_fine(
+            &valsA[0], &valsB[0], valueNb, coarseCC, -1000, 1000,
+            decimation, candidateNb, candidates);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        EXPECT_EQ(directCC.delay, coarseCC.delay);
+        EXPECT_EQ(directCC.coefficient, coarseCC.coefficient);
+
+        ASSERT_EQ(candidateNb, candidates.size());
+        // Best candidate first, on the peak
+        EXPECT_LE(std::abs(candidates[0].delay - realDelay), ssize_t(decimation));
+        for (size_t i = 1; i < candidates.size(); i++) {
+            EXPECT_GE(candidates[i - 1].coefficient, candidates[i].coefficient);
+        }
+
+        // Without decimation, the search is exhaustive
+        result = SignalProcessing<T>::cross_correlate_coarse_to_fine(
+            &valsA[0], &valsB[0], valueNb, coarseCC, -1000, 1000, 1, candidateNb, candidates);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_TRUE(candidates.empty());
+        EXPECT_EQ(directCC.delay, coarseCC.delay);
+
+        // Without candidate, the search is exhaustive
+        result = SignalProcessing<T>::cross_correlate_coarse_to_fine(
+            &valsA[0], &valsB[0], valueNb, coarseCC, -1000, 1000,
+            decimation, 0, candidates);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_TRUE(candidates.empty());
+        EXPECT_EQ(directCC.delay, coarseCC.delay);
+        EXPECT_EQ(directCC.coefficient, coarseCC.coefficient);
+
+        // Delay range narrower than the decimation, without any multiple of it
+        const ssize_t smallDelay = 2;
+        TestSignal<T>::delay(valsA, valsB, smallDelay);
+        result = SignalProcessing<T>::cross_correlate_direct(
+            &valsA[0], &valsB[0], valueNb, directCC, 1, 3);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        result = SignalProcessing<T>::cross_correlate_coarse_to_fine(
+            &valsA[0], &valsB[0], valueNb, coarseCC, 1, 3,
+            decimation, candidateNb, candidates);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(smallDelay, coarseCC.delay);
+        EXPECT_EQ(directCC.delay, coarseCC.delay);
+        EXPECT_EQ(directCC.coefficient, coarseCC.coefficient);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(CoarseToFineCrossCorrelationTest, SignalProcessingTestTypes);
+
+/** Band limited signal f(t) = sum of sines. */
+template <class T>
+static void smoothSignal(std::vector<T> &signal, size_t valueNb, double delay, double drift)
+{
+    signal.resize(valueNb);
+    for (size_t i = 0; i < valueNb; i++) {
+        double t = i - delay - drift * i;
+        signal[i] = static_cast<T>(50 * sin(0.21 * t) + 40 * sin(0.37 * t + 1) +
+                                   30 * sin(0.53 * t + 2));
+    }
+}
+
+template <class T>
+struct SubSampleCrossCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 4000;
+        const double realDelay = 12.3;
+
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        smoothSignal(valsA, valueNb, 0, 0);
+        smoothSignal(valsB, valueNb, realDelay, 0);
+
+        typename SignalProcessing<T>::SubSampleCorrelationResult resultCC;
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::cross_correlate_subsample(
+                &valsA[0], &valsB[0], valueNb, resultCC, 0, 50);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        EXPECT_EQ(12, resultCC.peak.delay);
+        EXPECT_NEAR(realDelay, resultCC.delay, 0.02);
+        EXPECT_GT(resultCC.sharpness, 0);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(SubSampleCrossCorrelationTest, SignalProcessingTestTypes);
+
+template <class T>
+struct DriftTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 100000;
+        const double realDelay = 10;
+        const double realDrift = 1e-4;
+
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        smoothSignal(valsA, valueNb, 0, 0);
+        smoothSignal(valsB, valueNb, realDelay, realDrift);
+
+        typename SignalProcessing<T>::DriftResult drift;
+        typename SignalProcessing<T>::Result result =
+            SignalProcessing<T>::estimate_drift(
+                &valsA[0], &valsB[0], valueNb, 4000, 4000, drift, 0, 50);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+
+        EXPECT_EQ(25u, drift.windowNb);
+        EXPECT_NEAR(realDrift, drift.drift, 1e-6);
+        EXPECT_NEAR(realDelay, drift.delay, 0.05);
+
+        // A single window is not enough
+        result = SignalProcessing<T>::estimate_drift(
+            &valsA[0], &valsB[0], 4000, 4000, 4000, drift, 0, 50);
+        EXPECT_EQ(SignalProcessing<T>::NotEnoughData, result.getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(DriftTest, SignalProcessingTestTypes);
+
+template <class T>
+struct FftPreferredTest
+{
+    void operator()()
+    {
+        EXPECT_FALSE(SignalProcessing<T>::isFftPreferred(4, 0, 4));
+        EXPECT_FALSE(SignalProcessing<T>::isFftPreferred(48000, 0, 10));
+        EXPECT_TRUE(SignalProcessing<T>::isFftPreferred(48000, -4800, 4800));
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(FftPreferredTest, SignalProcessingTestTypes);
+
 } /* namespace signal_processing */
 } /* namespace utilities */
 } /* namespace audio_utilities */
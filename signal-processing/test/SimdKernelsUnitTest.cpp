@@ -0,0 +1,119 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/SignalProcessing.hpp"
+#include "TypedTest.hpp"
+#include "TestSignal.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST3 (int8_t, int16_t, int32_t) SimdKernelsTestTypes;
+
+static const details::SimdLevel simdLevels[] = {
+    details::SimdSse2, details::SimdAvx2, details::SimdNeon
+};
+
+/** Compare every kernel level supported by the cpu to the scalar one. */
+template <class T>
+struct SimdMatchesScalarTest
+{
+    void operator()()
+    {
+        // Not a multiple of any vector size to test the remainders
+        const size_t valueNb = 1003;
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        TestSignal<T>::noise(valsA, valueNb, 7);
+        TestSignal<T>::noise(valsB, valueNb, 8);
+        // Extreme values overflow the 16 bits multiply-add instructions.
+        for (size_t i = 0; i < 64; i++) {
+            valsA[i] = valsB[i] = std::numeric_limits<T>::min();
+        }
+
+        details::SimdLevel initialLevel = details::getSimdLevel();
+        ASSERT_TRUE(details::setSimdLevel(details::SimdScalar));
+
+        double mean = SignalProcessing<T>::mean(&valsA[0], valueNb);
+        double variance = SignalProcessing<T>::variance(mean, &valsA[0], valueNb);
+        double product = SignalProcessing<T>::normalizedOffsetProduct(
+            mean, 3, &valsA[0], &valsB[0], valueNb, -5);
+        typename SignalProcessing<T>::Statistics statistics =
+            SignalProcessing<T>::statistics(&valsB[0], valueNb);
+        const T clipLevel = std::numeric_limits<T>::max() / 2;
+        size_t crossingNb = details::zeroCrossings(&valsB[0], valueNb);
+        size_t clippedNb = details::clippedValues(&valsB[0], valueNb, clipLevel);
+
+        for (size_t l = 0; l < sizeof(simdLevels) / sizeof(simdLevels[0]); l++) {
+            if (not details::setSimdLevel(simdLevels[l])) {
+                continue;
+            }
+            EXPECT_EQ(mean, SignalProcessing<T>::mean(&valsA[0], valueNb)) << simdLevels[l];
+            EXPECT_NEAR(variance, SignalProcessing<T>::variance(mean, &valsA[0], valueNb),
+                        1e-12 * variance) << simdLevels[l];
+            EXPECT_NEAR(product, SignalProcessing<T>::normalizedOffsetProduct(
+                            mean, 3, &valsA[0], &valsB[0], valueNb, -5),
+                        1e-12 * variance) << simdLevels[l];
+
+            typename SignalProcessing<T>::Statistics simdStatistics =
+                SignalProcessing<T>::statistics(&valsB[0], valueNb);
+            EXPECT_EQ(statistics.min, simdStatistics.min) << simdLevels[l];
+            EXPECT_EQ(statistics.max, simdStatistics.max) << simdLevels[l];
+            EXPECT_NEAR(statistics.energy, simdStatistics.energy,
+                        1e-12 * statistics.energy) << simdLevels[l];
+
+            EXPECT_EQ(crossingNb, details::zeroCrossings(&valsB[0], valueNb)) << simdLevels[l];
+            EXPECT_EQ(clippedNb, details::clippedValues(&valsB[0], valueNb, clipLevel))
+                << simdLevels[l];
+        }
+
+        details::setSimdLevel(initialLevel);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(SimdMatchesScalarTest, SimdKernelsTestTypes);
+
+/** Centred accumulation must not suffer from cancellation. */
+template <class T>
+struct ConstLongSignalVarianceTest
+{
+    void operator()()
+    {
+        std::vector<T> vals(100003, std::numeric_limits<T>::max() - 1);
+        double mean = SignalProcessing<T>::mean(&vals[0], vals.size());
+
+        EXPECT_EQ(std::numeric_limits<T>::max() - 1, mean);
+        EXPECT_EQ(0, SignalProcessing<T>::variance(mean, &vals[0], vals.size()));
+        EXPECT_EQ(0, SignalProcessing<T>::normalizedOffsetProduct(
+                      mean, mean, &vals[0], &vals[0], vals.size(), 17));
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(ConstLongSignalVarianceTest, SimdKernelsTestTypes);
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
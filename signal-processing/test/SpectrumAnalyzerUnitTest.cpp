@@ -0,0 +1,167 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/SpectrumAnalyzer.hpp"
+#include "TypedTest.hpp"
+#include "TestSignal.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST4 (int8_t, int16_t, int32_t, float) SpectrumAnalyzerTestTypes;
+
+static const double sampleRate = 48000;
+
+/** Rounded rather than truncated, truncation adds a lot of distortion to 8 bits signals. */
+template <class T>
+static T quantize(double value)
+{
+    return static_cast<T>(std::numeric_limits<T>::is_integer ? floor(value + 0.5) : value);
+}
+
+template <class T>
+struct PowerSpectrumTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 48000;
+        const double amplitude = std::min<double>(std::numeric_limits<T>::max(), 1e6) / 2;
+
+        std::vector<T> signal(valueNb);
+        for (size_t i = 0; i < valueNb; i++) {
+            signal[i] = quantize<T>(amplitude * sin(2 * M_PI * 1000 * i / sampleRate));
+        }
+
+        SpectrumAnalyzer<T> analyzer(1024, sampleRate);
+        ASSERT_EQ(513u, analyzer.getBinNb());
+
+        std::vector<double> psd;
+        ASSERT_TRUE(analyzer.powerSpectrum(&signal[0], valueNb, psd).isSuccess());
+        ASSERT_EQ(analyzer.getBinNb(), psd.size());
+
+        // The power of the sinusoid is around its frequency
+        double power = 0;
+        size_t peak = 0;
+        for (size_t bin = 0; bin < psd.size(); bin++) {
+            power += psd[bin] * analyzer.getBinFrequency(1);
+            peak = psd[bin] > psd[peak] ? bin : peak;
+        }
+        EXPECT_NEAR(amplitude * amplitude / 2, power, amplitude * amplitude * 0.01);
+        EXPECT_NEAR(1000, analyzer.getBinFrequency(peak), analyzer.getBinFrequency(1));
+
+        EXPECT_EQ(SignalProcessing<T>::NotEnoughData,
+                  analyzer.powerSpectrum(&signal[0], 1000, psd).getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(PowerSpectrumTest, SpectrumAnalyzerTestTypes);
+
+template <class T>
+struct DistortionTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 48000;
+        const double amplitude = std::min<double>(std::numeric_limits<T>::max(), 1e6) / 2;
+        const double noiseAmplitude = amplitude * 0.02;
+
+        // Second harmonic at -20 dB, uniform noise at -35.7 dB
+        std::vector<double> noise;
+        TestSignal<double>::noise(noise, valueNb, 3, noiseAmplitude);
+        std::vector<T> signal(valueNb);
+        for (size_t i = 0; i < valueNb; i++) {
+            double phase = 2 * M_PI * 997 * i / sampleRate;
+            signal[i] = quantize<T>(amplitude * sin(phase) +
+                                    amplitude * 0.1 * sin(2 * phase + 1) + noise[i]);
+        }
+
+        SpectrumAnalyzer<T> analyzer(4096, sampleRate, SpectrumAnalyzer<T>::BlackmanHarris);
+        typename SpectrumAnalyzer<T>::Distortion result;
+        ASSERT_TRUE(analyzer.distortion(&signal[0], valueNb, result).isSuccess());
+
+        EXPECT_NEAR(997, result.fundamental, 1);
+        EXPECT_NEAR(amplitude * amplitude / 2, result.signalPower, amplitude * amplitude * 0.01);
+        EXPECT_NEAR(-20, result.thd, 0.5);
+        double expectedSnr = 10 * log10(amplitude * amplitude / 2 /
+                                        (noiseAmplitude * noiseAmplitude / 3));
+        EXPECT_NEAR(expectedSnr, result.snr, 1.5);
+        EXPECT_GT(result.thdN, result.thd);
+
+        std::vector<T> silence(valueNb, 0);
+        EXPECT_EQ(SignalProcessing<T>::ConstSignal,
+                  analyzer.distortion(&silence[0], valueNb, result).getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(DistortionTest, SpectrumAnalyzerTestTypes);
+
+template <class T>
+struct FrequencyResponseTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 20000;
+        std::vector<T> reference;
+        TestSignal<T>::noise(reference, valueNb, 5, std::numeric_limits<T>::max() / 2);
+
+        // Low pass filter: H(w) = 0.5 + 0.25 * exp(-iw)
+        std::vector<T> capture(valueNb);
+        for (size_t i = 0; i < valueNb; i++) {
+            capture[i] = quantize<T>(0.5 * reference[i] + (i > 0 ? 0.25 * reference[i - 1] : 0));
+        }
+
+        SpectrumAnalyzer<T> analyzer(256, sampleRate);
+        std::vector<typename SpectrumAnalyzer<T>::Complex> response;
+        std::vector<double> coherence;
+        ASSERT_TRUE(analyzer.frequencyResponse(&reference[0], &capture[0], valueNb,
+                                               response, coherence).isSuccess());
+        ASSERT_EQ(analyzer.getBinNb(), response.size());
+        ASSERT_EQ(analyzer.getBinNb(), coherence.size());
+
+        for (size_t bin = 1; bin < analyzer.getBinNb() - 1; bin += 16) {
+            double omega = 2 * M_PI * bin / 256;
+            std::complex<double> expected = 0.5 + std::polar(0.25, -omega);
+            EXPECT_NEAR(std::abs(expected), std::abs(response[bin]), 0.02) << bin;
+            EXPECT_NEAR(std::arg(expected), std::arg(response[bin]), 0.05) << bin;
+            EXPECT_GT(coherence[bin], 0.95) << bin;
+            EXPECT_LE(coherence[bin], 1 + 1e-12) << bin;
+        }
+
+        std::vector<T> silence(valueNb, 0);
+        EXPECT_EQ(SignalProcessing<T>::ConstSignal,
+                  analyzer.frequencyResponse(&silence[0], &capture[0], valueNb,
+                                             response, coherence).getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(FrequencyResponseTest, SpectrumAnalyzerTestTypes);
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
@@ -0,0 +1,121 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/StreamingCorrelator.hpp"
+#include "TypedTest.hpp"
+#include "TestSignal.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST3 (int8_t, int16_t, int32_t) StreamingCorrelatorTestTypes;
+
+template <class T>
+struct StreamingCorrelationTest
+{
+    void operator()()
+    {
+        const size_t valueNb = 20000;
+        const size_t windowSize = 2000;
+        const size_t hopSize = 1500;
+        const ssize_t realDelay = 31;
+
+        std::vector<T> valsA;
+        std::vector<T> valsB;
+        TestSignal<T>::noise(valsA, valueNb, 13);
+        TestSignal<T>::delay(valsA, valsB, realDelay);
+
+        StreamingCorrelator<T> correlator(windowSize, hopSize, -50, 50);
+
+        // Push chunks of different sizes on each signal
+        size_t pushedA = 0;
+        size_t pushedB = 0;
+        size_t estimateNb = 0;
+        while (pushedA < valueNb || pushedB < valueNb) {
+            size_t chunkA = std::min<size_t>(301, valueNb - pushedA);
+            // Do not let B get too far ahead of A, it would overflow
+            size_t chunkB = pushedB > pushedA + 1000 ?
+                            0 : std::min<size_t>(457, valueNb - pushedB);
+            ASSERT_TRUE(correlator.pushA(&valsA[0] + pushedA, chunkA).isSuccess());
+            ASSERT_TRUE(correlator.pushB(&valsB[0] + pushedB, chunkB).isSuccess());
+            pushedA += chunkA;
+            pushedB += chunkB;
+
+            while (correlator.isEstimateReady()) {
+                uint64_t windowStart = correlator.getWindowStart();
+                EXPECT_EQ(estimateNb * hopSize, windowStart);
+
+                typename StreamingCorrelator<T>::CrossCorrelationResult streamCC;
+                typename StreamingCorrelator<T>::Result result = correlator.estimate(streamCC);
+                ASSERT_TRUE(result.isSuccess()) << result.format();
+
+                typename SignalProcessing<T>::CrossCorrelationResult batchCC;
+                SignalProcessing<T>::cross_correlate(&valsA[windowStart], &valsB[windowStart],
+                                                     windowSize, batchCC, -50, 50);
+                EXPECT_EQ(realDelay, streamCC.delay);
+                EXPECT_EQ(batchCC.delay, streamCC.delay);
+                EXPECT_EQ(batchCC.coefficient, streamCC.coefficient);
+                estimateNb++;
+            }
+        }
+        EXPECT_EQ((valueNb - windowSize) / hopSize + 1, estimateNb);
+
+        typename SignalProcessing<T>::Statistics batch =
+            SignalProcessing<T>::statistics(&valsA[0], valueNb);
+        typename SignalProcessing<T>::Statistics stream = correlator.getStatisticsA();
+        EXPECT_EQ(batch.mean, stream.mean);
+        EXPECT_NEAR(batch.variance, stream.variance, 1e-12 * batch.variance);
+        EXPECT_EQ(batch.min, stream.min);
+        EXPECT_EQ(batch.max, stream.max);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(StreamingCorrelationTest, StreamingCorrelatorTestTypes);
+
+TEST(StreamingCorrelator, overflow)
+{
+    std::vector<int16_t> vals;
+    TestSignal<int16_t>::noise(vals, 1000, 17);
+
+    StreamingCorrelator<int16_t> correlator(100, 100, 0, 10, 500);
+
+    // B is not pushed, A can not go further than the capacity
+    EXPECT_TRUE(correlator.pushA(&vals[0], 500).isSuccess());
+    StreamingCorrelator<int16_t>::Result result = correlator.pushA(&vals[500], 1);
+    EXPECT_EQ(SignalProcessing<int16_t>::BufferOverflow, result.getErrorCode());
+
+    // Consuming windows makes room
+    EXPECT_TRUE(correlator.pushB(&vals[0], 200).isSuccess());
+    StreamingCorrelator<int16_t>::CrossCorrelationResult resultCC;
+    ASSERT_TRUE(correlator.isEstimateReady());
+    EXPECT_TRUE(correlator.estimate(resultCC).isSuccess());
+    EXPECT_EQ(0, resultCC.delay);
+    EXPECT_TRUE(correlator.pushA(&vals[500], 100).isSuccess());
+}
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
@@ -0,0 +1,76 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+/** Deterministic pseudo random signals generation for tests. */
+template <class T>
+struct TestSignal
+{
+    /** Fill a signal with uniform noise.
+     *
+     *  @param[out] signal to fill.
+     *  @param[in] valueNb number of values to generate.
+     *  @param[in] seed of the generator, same seed gives same signal.
+     *  @param[in] amplitude of the noise, clipped to the range of T.
+     */
+    static void noise(std::vector<T> &signal, size_t valueNb, uint32_t seed,
+                      double amplitude = std::numeric_limits<T>::max())
+    {
+        signal.resize(valueNb);
+        uint32_t state = seed;
+        for (size_t i = 0; i < valueNb; i++) {
+            // Numerical Recipes linear congruential generator
+            state = state * 1664525u + 1013904223u;
+            double uniform = (state >> 8) / double(1 << 24) * 2 - 1;
+            signal[i] = static_cast<T>(uniform * amplitude);
+        }
+    }
+
+    /** Copy a signal delayed by delay values, new values are filled with noise.
+     *
+     *  @param[in] source the signal to delay.
+     *  @param[out] delayed the delayed signal: delayed(t + delay) = source(t).
+     *  @param[in] delay in values, may be negative.
+     */
+    static void delay(const std::vector<T> &source, std::vector<T> &delayed, ssize_t delay)
+    {
+        noise(delayed, source.size(), 42);
+        for (size_t i = 0; i < source.size(); i++) {
+            ssize_t index = static_cast<ssize_t>(i) + delay;
+            if (index >= 0 && index < static_cast<ssize_t>(source.size())) {
+                delayed[index] = source[i];
+            }
+        }
+    }
+};
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
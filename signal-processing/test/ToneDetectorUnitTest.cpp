@@ -0,0 +1,125 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/ToneDetector.hpp"
+#include "TypedTest.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST4 (int8_t, int16_t, int32_t, float) ToneDetectorTestTypes;
+
+static const double sampleRate = 48000;
+
+/** Sum of a 1 kHz and a 3 kHz tones */
+template <class T>
+static void twoTones(std::vector<T> &signal, size_t valueNb, double amplitude)
+{
+    signal.resize(valueNb);
+    for (size_t i = 0; i < valueNb; i++) {
+        double t = i / sampleRate;
+        signal[i] = static_cast<T>(amplitude / 2 * cos(2 * M_PI * 1000 * t + 0.3) +
+                                   amplitude / 4 * cos(2 * M_PI * 3000 * t - 2));
+    }
+}
+
+template <class T>
+struct ToneDetectionTest
+{
+    void operator()()
+    {
+        // One second: integer number of periods of every tone
+        const size_t valueNb = 48000;
+        const double amplitude = std::min<double>(std::numeric_limits<T>::max(), 1e6);
+
+        std::vector<T> signal;
+        twoTones(signal, valueNb, amplitude);
+
+        std::vector<double> frequencies;
+        frequencies.push_back(1000);
+        frequencies.push_back(2000);
+        frequencies.push_back(3000);
+
+        std::vector<typename ToneDetector<T>::Tone> tones;
+        typename ToneDetector<T>::Result result =
+            ToneDetector<T>::detect(&signal[0], valueNb, frequencies, sampleRate, tones);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        ASSERT_EQ(3u, tones.size());
+
+        EXPECT_EQ(1000, tones[0].frequency);
+        EXPECT_NEAR(amplitude / 2, tones[0].magnitude, amplitude * 0.01);
+        EXPECT_NEAR(0.3, tones[0].phase, 0.02);
+
+        // Absent tone
+        EXPECT_LT(tones[1].magnitude, amplitude * 0.01);
+
+        EXPECT_NEAR(amplitude / 4, tones[2].magnitude, amplitude * 0.01);
+        EXPECT_NEAR(-2, tones[2].phase, 0.02);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(ToneDetectionTest, ToneDetectorTestTypes);
+
+template <class T>
+struct StreamingToneDetectionTest
+{
+    void operator()()
+    {
+        // Several recursion blocks
+        const size_t valueNb = 48000 * 5;
+        std::vector<T> signal;
+        twoTones(signal, valueNb, 100);
+
+        std::vector<double> frequencies(1, 1000);
+        std::vector<typename ToneDetector<T>::Tone> expected;
+        ToneDetector<T>::detect(&signal[0], valueNb, frequencies, sampleRate, expected);
+
+        ToneDetector<T> detector(frequencies, sampleRate);
+        std::vector<typename ToneDetector<T>::Tone> tones;
+        EXPECT_EQ(SignalProcessing<T>::NotEnoughData, detector.getTones(tones).getErrorCode());
+
+        const size_t chunkSize = 1001;
+        for (size_t pushed = 0; pushed < valueNb; pushed += chunkSize) {
+            detector.push(&signal[0] + pushed, std::min(chunkSize, valueNb - pushed));
+        }
+        EXPECT_EQ(valueNb, detector.getValueNb());
+        ASSERT_TRUE(detector.getTones(tones).isSuccess());
+        EXPECT_NEAR(expected[0].magnitude, tones[0].magnitude, 1e-9);
+        EXPECT_NEAR(expected[0].phase, tones[0].phase, 1e-9);
+
+        detector.reset();
+        EXPECT_EQ(0u, detector.getValueNb());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(StreamingToneDetectionTest, ToneDetectorTestTypes);
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
@@ -0,0 +1,259 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "signal-processing/WavReader.hpp"
+#include "TypedTest.hpp"
+#include "TestSignal.hpp"
+
+#include <utilities/TypeList.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+
+namespace audio_utilities
+{
+namespace utilities
+{
+namespace signal_processing
+{
+
+typedef TYPELIST3 (int16_t, int32_t, float) WavReaderTestTypes;
+
+/** Temporary file removed at destruction. */
+class TemporaryFile
+{
+public:
+    TemporaryFile() : mName("/tmp/wav_reader_test_XXXXXX")
+    {
+        int fd = mkstemp(&mName[0]);
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    ~TemporaryFile() { unlink(mName.c_str()); }
+
+    const char *getName() const { return mName.c_str(); }
+
+    void write(const std::string &content) const
+    {
+        FILE *file = fopen(mName.c_str(), "wb");
+        ASSERT_TRUE(file != NULL);
+        ASSERT_EQ(content.size(), fwrite(content.data(), 1, content.size(), file));
+        fclose(file);
+    }
+
+private:
+    std::string mName;
+};
+
+static void appendLittleEndian(std::string &bytes, uint32_t value, size_t byteNb)
+{
+    for (size_t i = 0; i < byteNb; i++) {
+        bytes += char((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/** @return a WAV file holding frames, preceded by a chunk of listSize bytes to skip,
+ *          odd by default. */
+template <class T>
+static std::string wavFile(const std::vector<T> &frames, uint16_t channelNb, uint16_t tag,
+                           uint32_t dataSize, uint32_t listSize = 3)
+{
+    std::string fmt;
+    appendLittleEndian(fmt, tag, 2);
+    appendLittleEndian(fmt, channelNb, 2);
+    appendLittleEndian(fmt, 48000, 4);
+    appendLittleEndian(fmt, 48000 * channelNb * sizeof(T), 4);
+    appendLittleEndian(fmt, channelNb * sizeof(T), 2);
+    appendLittleEndian(fmt, 8 * sizeof(T), 2);
+
+    std::string file = "RIFF";
+    appendLittleEndian(file, 0, 4);
+    file += "WAVEfmt ";
+    appendLittleEndian(file, fmt.size(), 4);
+    file += fmt;
+    file += "LIST";
+    appendLittleEndian(file, listSize, 4);
+    file += std::string(listSize + (listSize & 1), '\0');
+    file += "data";
+    appendLittleEndian(file, dataSize, 4);
+    file.append(reinterpret_cast<const char *>(&frames[0]), frames.size() * sizeof(T));
+    return file;
+}
+
+template <class T>
+struct WavChannelsTest
+{
+    void operator()()
+    {
+        const size_t frameNb = 2000;
+        const uint16_t channelNb = 3;
+        const ssize_t delay = 12;
+
+        std::vector<T> reference;
+        std::vector<T> delayed;
+        TestSignal<T>::noise(reference, frameNb, 17);
+        TestSignal<T>::delay(reference, delayed, delay);
+        std::vector<T> frames(frameNb * channelNb, 0);
+        for (size_t i = 0; i < frameNb; i++) {
+            frames[i * channelNb] = reference[i];
+            frames[i * channelNb + 2] = delayed[i];
+        }
+
+        TemporaryFile file;
+        file.write(wavFile(frames, channelNb, details::WavSampleFormat<T>::tag,
+                           frames.size() * sizeof(T)));
+
+        WavReader<T> reader(file.getName());
+        typename WavReader<T>::Result result = reader.map();
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(channelNb, reader.getChannelNb());
+        EXPECT_EQ(48000u, reader.getSampleRate());
+        ASSERT_EQ(frameNb, reader.getFrameNb());
+
+        StridedSignal<T> channel = reader.getChannel(2);
+        EXPECT_EQ(channelNb, channel.getStride());
+        EXPECT_EQ(delayed[5], channel[5]);
+
+        typename SignalProcessing<T>::CrossCorrelationResult resultCC;
+        ASSERT_TRUE(SignalProcessing<T>::cross_correlate(reader.getChannel(0),
+                                                         reader.getChannel(2), frameNb,
+                                                         resultCC, -50, 50).isSuccess());
+        EXPECT_EQ(delay, resultCC.delay);
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(WavChannelsTest, WavReaderTestTypes);
+
+template <class T>
+struct WavInvalidFileTest
+{
+    void operator()()
+    {
+        std::vector<T> frames(100, 1);
+        TemporaryFile file;
+
+        // Recording interrupted before the header update
+        file.write(wavFile(frames, 2, details::WavSampleFormat<T>::tag, 0xFFFFFFFF));
+        {
+            WavReader<T> reader(file.getName());
+            ASSERT_TRUE(reader.map().isSuccess());
+            EXPECT_EQ(50u, reader.getFrameNb());
+        }
+
+        file.write(wavFile(frames, 2, 0x0006 /* A-law */, frames.size() * sizeof(T)));
+        {
+            WavReader<T> reader(file.getName());
+            EXPECT_EQ(WavReader<T>::UnsupportedFormat, reader.map().getErrorCode());
+        }
+
+        file.write("RIFX not a wav file");
+        {
+            WavReader<T> reader(file.getName());
+            EXPECT_EQ(WavReader<T>::InvalidFile, reader.map().getErrorCode());
+            EXPECT_TRUE(reader.getFrames() == NULL);
+        }
+
+        file.write("");
+        {
+            WavReader<T> reader(file.getName());
+            EXPECT_EQ(WavReader<T>::InvalidFile, reader.map().getErrorCode());
+        }
+
+        // Legal, but samples can not be read in place
+        file.write(wavFile(frames, 2, details::WavSampleFormat<T>::tag,
+                           frames.size() * sizeof(T), 2));
+        {
+            WavReader<T> reader(file.getName());
+            if (sizeof(T) == 2) {
+                EXPECT_TRUE(reader.map().isSuccess());
+            } else {
+                EXPECT_EQ(WavReader<T>::UnsupportedFormat, reader.map().getErrorCode());
+            }
+        }
+
+        WavReader<T> missing("/nonexistent/file.wav");
+        EXPECT_EQ(WavReader<T>::MappingError, missing.map().getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(WavInvalidFileTest, WavReaderTestTypes);
+
+template <class T>
+struct WavWindowTest
+{
+    void operator()()
+    {
+        // Windows are larger than a page, the last one being shorter
+        const size_t frameNb = 5000;
+        const uint16_t channelNb = 2;
+        const size_t windowFrameNb = 1500;
+        const size_t overlapFrameNb = 100;
+
+        std::vector<T> frames;
+        TestSignal<T>::noise(frames, frameNb * channelNb, 23);
+
+        TemporaryFile file;
+        file.write(wavFile(frames, channelNb, details::WavSampleFormat<T>::tag,
+                           frames.size() * sizeof(T)));
+
+        WavReader<T> reader(file.getName());
+        typename WavReader<T>::Result result = reader.mapWindow(windowFrameNb, overlapFrameNb);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        EXPECT_EQ(frameNb, reader.getDataFrameNb());
+
+        uint64_t expectedFirst = 0;
+        size_t windowNb = 0;
+        for (; result.isSuccess(); result = reader.nextWindow(), windowNb++) {
+            ASSERT_EQ(expectedFirst, reader.getFirstFrame());
+            size_t expectedNb = std::min<size_t>(windowFrameNb, frameNb - expectedFirst);
+            ASSERT_EQ(expectedNb, reader.getFrameNb());
+            StridedSignal<T> channel = reader.getChannel(1);
+            for (size_t i = 0; i < expectedNb; i++) {
+                ASSERT_EQ(frames[(expectedFirst + i) * channelNb + 1], channel[i]);
+            }
+            expectedFirst += windowFrameNb - overlapFrameNb;
+        }
+        EXPECT_EQ(WavReader<T>::EndOfData, result.getErrorCode());
+        EXPECT_EQ(4u, windowNb);
+        // The last window stays mapped
+        EXPECT_EQ(frameNb, reader.getFirstFrame() + reader.getFrameNb());
+
+        // The whole data can still be mapped
+        ASSERT_TRUE(reader.map().isSuccess());
+        EXPECT_EQ(0u, reader.getFirstFrame());
+        EXPECT_EQ(frameNb, reader.getFrameNb());
+        EXPECT_EQ(frames.back(), reader.getFrames()[frames.size() - 1]);
+
+        // Empty data
+        file.write(wavFile(frames, channelNb, details::WavSampleFormat<T>::tag, 0));
+        WavReader<T> empty(file.getName());
+        EXPECT_EQ(WavReader<T>::EndOfData, empty.mapWindow(windowFrameNb).getErrorCode());
+    }
+};
+
+AUDIOUTILITIES_TYPED_TEST(WavWindowTest, WavReaderTestTypes);
+
+} /* namespace signal_processing */
+} /* namespace utilities */
+} /* namespace audio_utilities */
@@ -0,0 +1,155 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/FileMapperRegistry.hpp"
+#include "TemporaryFile.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+
+using audio_utilities::utilities::FileMapper;
+using audio_utilities::utilities::FileMapperRegistry;
+using audio_utilities::utilities::SharedFileMapping;
+
+typedef FileMapperRegistry<int32_t> Registry;
+typedef SharedFileMapping<int32_t> Mapping;
+
+TEST(FileMapperRegistry, sharing)
+{
+    Registry &registry = Registry::getInstance();
+    const size_t mappedFileNb = registry.getMappedFileNb();
+    TemporaryFile file;
+    file.fill(1000);
+
+    Mapping first;
+    Mapping second;
+    EXPECT_TRUE(first.getMappedFile() == NULL);
+    EXPECT_EQ(0u, first.getMappedFileSize());
+    EXPECT_FALSE(first.isUpToDate());
+
+    ASSERT_TRUE(registry.acquire(file.getName(), first).isSuccess());
+    ASSERT_TRUE(registry.acquire(file.getName(), second).isSuccess());
+    EXPECT_EQ(mappedFileNb + 1, registry.getMappedFileNb());
+    EXPECT_TRUE(first.getMappedFile() == second.getMappedFile());
+    EXPECT_EQ(1000u, first.getMappedFileSize());
+    EXPECT_EQ(999, first.getMappedFile()[999]);
+    EXPECT_TRUE(first.isUpToDate());
+
+    // Released with the last view
+    first.reset();
+    EXPECT_TRUE(first.getMappedFile() == NULL);
+    EXPECT_EQ(mappedFileNb + 1, registry.getMappedFileNb());
+    EXPECT_EQ(999, second.getMappedFile()[999]);
+    second.reset();
+    EXPECT_EQ(mappedFileNb, registry.getMappedFileNb());
+
+    Mapping missing;
+    EXPECT_EQ(FileMapper<int32_t>::NoSuchFile,
+              registry.acquire("/nonexistent/file", missing).getErrorCode());
+    EXPECT_TRUE(missing.getMappedFile() == NULL);
+}
+
+TEST(FileMapperRegistry, copies)
+{
+    Registry &registry = Registry::getInstance();
+    const size_t mappedFileNb = registry.getMappedFileNb();
+    TemporaryFile file;
+    file.fill(10);
+    TemporaryFile otherFile;
+    otherFile.fill(20);
+
+    Mapping original;
+    ASSERT_TRUE(registry.acquire(file.getName(), original).isSuccess());
+    {
+        Mapping copy(original);
+        Mapping assigned;
+        assigned = copy;
+        // Assigned to itself, the view is kept
+        Mapping &self = assigned;
+        assigned = self;
+        ASSERT_TRUE(assigned.getMappedFile() == original.getMappedFile());
+        EXPECT_EQ(5, assigned.getMappedFile()[5]);
+
+        original.reset();
+        EXPECT_EQ(mappedFileNb + 1, registry.getMappedFileNb());
+        EXPECT_EQ(5, copy.getMappedFile()[5]);
+
+        // Assigned over an other file, the other file being released
+        Mapping other;
+        ASSERT_TRUE(registry.acquire(otherFile.getName(), other).isSuccess());
+        EXPECT_EQ(mappedFileNb + 2, registry.getMappedFileNb());
+        other = copy;
+        EXPECT_EQ(mappedFileNb + 1, registry.getMappedFileNb());
+        EXPECT_EQ(10u, other.getMappedFileSize());
+
+        // Acquired over a view, the view being released
+        ASSERT_TRUE(registry.acquire(file.getName(), copy).isSuccess());
+        EXPECT_EQ(mappedFileNb + 1, registry.getMappedFileNb());
+
+        Mapping empty;
+        assigned = empty;
+        EXPECT_TRUE(assigned.getMappedFile() == NULL);
+    }
+    EXPECT_EQ(mappedFileNb, registry.getMappedFileNb());
+}
+
+TEST(FileMapperRegistry, changedFile)
+{
+    Registry &registry = Registry::getInstance();
+    const size_t mappedFileNb = registry.getMappedFileNb();
+    TemporaryFile file;
+    file.fill(4, 1);
+
+    Mapping previous;
+    ASSERT_TRUE(registry.acquire(file.getName(), previous).isSuccess());
+    EXPECT_TRUE(previous.isUpToDate());
+
+    // Replaced by a rename: the previous version stays mapped
+    TemporaryFile replacement;
+    replacement.fill(2, 7);
+    ASSERT_EQ(0, rename(replacement.getName(), file.getName()));
+    EXPECT_FALSE(previous.isUpToDate());
+
+    Mapping current;
+    ASSERT_TRUE(registry.acquire(file.getName(), current).isSuccess());
+    EXPECT_TRUE(current.isUpToDate());
+    // Only the current version is registered
+    EXPECT_EQ(mappedFileNb + 1, registry.getMappedFileNb());
+    ASSERT_EQ(2u, current.getMappedFileSize());
+    EXPECT_EQ(7, current.getMappedFile()[0]);
+    ASSERT_EQ(4u, previous.getMappedFileSize());
+    EXPECT_EQ(1, previous.getMappedFile()[0]);
+    EXPECT_EQ(4, previous.getMappedFile()[3]);
+
+    // Acquired again, the current version is shared
+    Mapping shared;
+    ASSERT_TRUE(registry.acquire(file.getName(), shared).isSuccess());
+    EXPECT_TRUE(shared.getMappedFile() == current.getMappedFile());
+
+    // Rewritten in place
+    file.fill(3, 20);
+    EXPECT_FALSE(current.isUpToDate());
+    ASSERT_TRUE(registry.acquire(file.getName(), shared).isSuccess());
+    ASSERT_EQ(3u, shared.getMappedFileSize());
+    EXPECT_EQ(22, shared.getMappedFile()[2]);
+
+    previous.reset();
+    current.reset();
+    shared.reset();
+    EXPECT_EQ(mappedFileNb, registry.getMappedFileNb());
+}
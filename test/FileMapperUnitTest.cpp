@@ -0,0 +1,328 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/FileMapper.hpp"
+#include "TemporaryFile.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using audio_utilities::utilities::FileMapper;
+
+typedef FileMapper<int32_t> Mapper;
+
+TEST(FileMapper, map)
+{
+    const size_t valueNb = 10007;
+    TemporaryFile file;
+    file.fill(valueNb);
+
+    Mapper mapper(file.getName());
+    Mapper::Result result = mapper.map();
+    ASSERT_TRUE(result.isSuccess()) << result.format();
+    ASSERT_EQ(valueNb, mapper.getMappedFileSize());
+    EXPECT_EQ(valueNb, mapper.getFileValueNb());
+    EXPECT_EQ(0u, mapper.getMappedFilePosition());
+    EXPECT_EQ(int32_t(valueNb - 1), mapper.getMappedFile()[valueNb - 1]);
+
+    Mapper missing("/nonexistent/file");
+    EXPECT_EQ(Mapper::NoSuchFile, missing.map().getErrorCode());
+    EXPECT_TRUE(missing.getMappedFile() == NULL);
+}
+
+TEST(FileMapper, windows)
+{
+    // Windows larger than a page, overlapping, the file not being a multiple of them
+    const size_t valueNb = 100003;
+    const size_t windowValueNb = 10001;
+    const size_t overlapValueNb = 101;
+    TemporaryFile file;
+    file.fill(valueNb);
+
+    Mapper mapper(file.getName());
+    uint64_t expectedPosition = 0;
+    uint64_t coveredNb = 0;
+    size_t windowNb = 0;
+    Mapper::Result result = mapper.mapWindow(windowValueNb, overlapValueNb);
+    for (; result.isSuccess(); result = mapper.nextWindow(), windowNb++) {
+        ASSERT_EQ(expectedPosition, mapper.getMappedFilePosition());
+        size_t expectedNb = std::min<uint64_t>(windowValueNb, valueNb - expectedPosition);
+        ASSERT_EQ(expectedNb, mapper.getMappedFileSize());
+        const int32_t *values = mapper.getMappedFile();
+        for (size_t i = 0; i < expectedNb; i++) {
+            ASSERT_EQ(int32_t(expectedPosition + i), values[i]);
+        }
+        coveredNb = expectedPosition + expectedNb;
+        expectedPosition += windowValueNb - overlapValueNb;
+    }
+    EXPECT_EQ(Mapper::EndOfFile, result.getErrorCode());
+    EXPECT_EQ(valueNb, coveredNb);
+    EXPECT_EQ(11u, windowNb);
+
+    // The last window stays mapped, and the end is reported again
+    ASSERT_TRUE(mapper.getMappedFile() != NULL);
+    EXPECT_EQ(int32_t(valueNb - 1), mapper.getMappedFile()[mapper.getMappedFileSize() - 1]);
+    EXPECT_EQ(Mapper::EndOfFile, mapper.nextWindow().getErrorCode());
+
+    // Window starting within the file
+    result = mapper.mapWindow(windowValueNb, 0, valueNb - 3);
+    ASSERT_TRUE(result.isSuccess()) << result.format();
+    EXPECT_EQ(3u, mapper.getMappedFileSize());
+    EXPECT_EQ(int32_t(valueNb - 3), mapper.getMappedFile()[0]);
+    EXPECT_EQ(Mapper::EndOfFile, mapper.mapWindow(windowValueNb, 0, valueNb).getErrorCode());
+}
+
+TEST(FileMapper, windowErrors)
+{
+    TemporaryFile file;
+    file.fill(0);
+
+    Mapper empty(file.getName());
+    EXPECT_EQ(Mapper::EndOfFile, empty.mapWindow(100).getErrorCode());
+    EXPECT_TRUE(empty.getMappedFile() == NULL);
+    EXPECT_TRUE(empty.nextWindow().isFailure());
+
+    file.fill(10);
+    Mapper mapper(file.getName());
+    EXPECT_TRUE(mapper.nextWindow().isFailure());
+    EXPECT_TRUE(mapper.mapWindow(0).isFailure());
+    EXPECT_TRUE(mapper.mapWindow(10, 10).isFailure());
+
+    // Single window shorter than asked
+    ASSERT_TRUE(mapper.mapWindow(100, 50).isSuccess());
+    EXPECT_EQ(10u, mapper.getMappedFileSize());
+    EXPECT_EQ(Mapper::EndOfFile, mapper.nextWindow().getErrorCode());
+
+    Mapper missing("/nonexistent/file");
+    EXPECT_EQ(Mapper::NoSuchFile, missing.mapWindow(100).getErrorCode());
+}
+
+TEST(FileMapper, createResizeSync)
+{
+    const size_t chunkValueNb = 1000;
+    const size_t chunkNb = 50;
+    const size_t growthValueNb = 4096;
+    TemporaryFile file;
+
+    {
+        Mapper writer(file.getName());
+        EXPECT_TRUE(writer.getWritableFile() == NULL);
+        EXPECT_TRUE(writer.resize(10).isFailure());
+        EXPECT_TRUE(writer.sync().isFailure());
+
+        Mapper::Result result = writer.create(chunkValueNb);
+        ASSERT_TRUE(result.isSuccess()) << result.format();
+        ASSERT_TRUE(writer.getWritableFile() != NULL);
+        EXPECT_EQ(0, writer.getWritableFile()[chunkValueNb - 1]);
+
+        // Grown chunk by chunk, the mapping possibly moving
+        size_t writtenNb = 0;
+        for (size_t chunk = 0; chunk < chunkNb; chunk++) {
+            if (writtenNb + chunkValueNb > writer.getMappedFileSize()) {
+                result = writer.resize(writer.getMappedFileSize() + growthValueNb);
+                ASSERT_TRUE(result.isSuccess()) << result.format();
+            }
+            int32_t *values = writer.getWritableFile();
+            for (size_t i = 0; i < chunkValueNb; i++) {
+                values[writtenNb + i] = int32_t(writtenNb + i);
+            }
+            writtenNb += chunkValueNb;
+        }
+        EXPECT_TRUE(writer.sync(Mapper::Asynchronous).isSuccess());
+
+        // Shrunk to the values written
+        ASSERT_TRUE(writer.resize(writtenNb).isSuccess());
+        EXPECT_EQ(writtenNb, writer.getMappedFileSize());
+        EXPECT_EQ(writtenNb, writer.getFileValueNb());
+        EXPECT_TRUE(writer.sync().isSuccess());
+
+        // A created file is only written through its shared mapping
+        EXPECT_TRUE(writer.map().isFailure());
+        EXPECT_TRUE(writer.mapWindow(10).isFailure());
+        EXPECT_TRUE(writer.create(10).isFailure());
+        EXPECT_TRUE(writer.resize(0).isFailure());
+        EXPECT_EQ(writtenNb, writer.getMappedFileSize());
+    }
+
+    Mapper reader(file.getName());
+    ASSERT_TRUE(reader.map().isSuccess());
+    ASSERT_EQ(chunkNb * chunkValueNb, reader.getMappedFileSize());
+    EXPECT_TRUE(reader.getWritableFile() == NULL);
+    EXPECT_TRUE(reader.resize(10).isFailure());
+    EXPECT_TRUE(reader.create(10).isFailure());
+    const int32_t *values = reader.getMappedFile();
+    for (size_t i = 0; i < reader.getMappedFileSize(); i++) {
+        ASSERT_EQ(int32_t(i), values[i]);
+    }
+
+    Mapper missing("/nonexistent/file");
+    EXPECT_EQ(Mapper::NoSuchFile, missing.create(10).getErrorCode());
+}
+
+/** Append values to a file from a thread, each chunk of values in two writes,
+ *  the first one ending in the middle of a value. */
+class AppendingWriter
+{
+public:
+    static const size_t chunkValueNb = 501;
+
+    AppendingWriter(const char *fileName, size_t chunkNb, useconds_t startDelayUs = 0)
+        : mFileName(fileName), mChunkNb(chunkNb), mStartDelayUs(startDelayUs)
+    {}
+
+    bool start() { return pthread_create(&mThread, NULL, run, this) == 0; }
+
+    void join() { pthread_join(mThread, NULL); }
+
+private:
+    static void *run(void *context)
+    {
+        AppendingWriter *writer = static_cast<AppendingWriter *>(context);
+        usleep(writer->mStartDelayUs);
+        int fd = open(writer->mFileName, O_WRONLY | O_APPEND);
+        for (size_t chunk = 0; fd >= 0 && chunk < writer->mChunkNb; chunk++) {
+            int32_t values[chunkValueNb];
+            for (size_t i = 0; i < chunkValueNb; i++) {
+                values[i] = int32_t(chunk * chunkValueNb + i);
+            }
+            const size_t splitSize = 301;
+            if (write(fd, values, splitSize) != ssize_t(splitSize)) {
+                break;
+            }
+            usleep(500);
+            if (write(fd, reinterpret_cast<char *>(values) + splitSize,
+                      sizeof(values) - splitSize) != ssize_t(sizeof(values) - splitSize)) {
+                break;
+            }
+            usleep(1000);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    const char *mFileName;
+    const size_t mChunkNb;
+    const useconds_t mStartDelayUs;
+    pthread_t mThread;
+};
+
+/** Follow a file while a writer appends to it, checking every value. */
+static void followWriter(Mapper &mapper, const char *fileName)
+{
+    const size_t chunkNb = 100;
+
+    size_t newValueNb;
+    EXPECT_TRUE(mapper.waitForValues(0, newValueNb).isSuccess());
+    EXPECT_EQ(0u, newValueNb);
+
+    AppendingWriter writer(fileName, chunkNb);
+    ASSERT_TRUE(writer.start());
+    size_t totalNb = 0;
+    while (mapper.waitForValues(500, newValueNb).isSuccess() && newValueNb > 0) {
+        // Only complete values are mapped
+        const int32_t *values = mapper.getMappedFile();
+        for (size_t i = totalNb; i < totalNb + newValueNb; i++) {
+            ASSERT_EQ(int32_t(i), values[i]);
+        }
+        totalNb += newValueNb;
+        ASSERT_EQ(totalNb, mapper.getMappedFileSize());
+        ASSERT_TRUE(mapper.release(0, totalNb).isSuccess());
+    }
+    writer.join();
+    EXPECT_EQ(chunkNb * AppendingWriter::chunkValueNb, totalNb);
+}
+
+TEST(FileMapper, follow)
+{
+    TemporaryFile file;
+    file.fill(0);
+
+    Mapper mapper(file.getName());
+    Mapper::Result result = mapper.follow();
+    ASSERT_TRUE(result.isSuccess()) << result.format();
+    EXPECT_EQ(0u, mapper.getMappedFileSize());
+    EXPECT_TRUE(mapper.follow().isFailure());
+
+    followWriter(mapper, file.getName());
+}
+
+TEST(FileMapper, followPolling)
+{
+    TemporaryFile file;
+    file.fill(0);
+
+    // Leave a single descriptor, for the file: inotify can not be initialized
+    int firstFreeFd = dup(0);
+    ASSERT_GE(firstFreeFd, 0);
+    close(firstFreeFd);
+    struct rlimit limit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+    struct rlimit reducedLimit = limit;
+    reducedLimit.rlim_cur = firstFreeFd + 1;
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &reducedLimit));
+
+    Mapper mapper(file.getName());
+    Mapper::Result result = mapper.follow();
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &limit));
+    ASSERT_TRUE(result.isSuccess()) << result.format();
+
+    int fd = dup(0);
+    EXPECT_EQ(firstFreeFd + 1, fd) << "inotify descriptor opened";
+    close(fd);
+
+    followWriter(mapper, file.getName());
+}
+
+TEST(FileMapper, followTimeouts)
+{
+    TemporaryFile file;
+    file.fill(10);
+
+    Mapper mapper(file.getName());
+    size_t newValueNb;
+    EXPECT_TRUE(mapper.waitForValues(0, newValueNb).isFailure());
+    ASSERT_TRUE(mapper.follow().isSuccess());
+    EXPECT_EQ(10u, mapper.getMappedFileSize());
+
+    // Only checked
+    EXPECT_TRUE(mapper.waitForValues(0, newValueNb).isSuccess());
+    EXPECT_EQ(0u, newValueNb);
+
+    // Expired
+    EXPECT_TRUE(mapper.waitForValues(20, newValueNb).isSuccess());
+    EXPECT_EQ(0u, newValueNb);
+
+    // Waiting forever, until the writer starts
+    AppendingWriter writer(file.getName(), 1, 50 * 1000);
+    ASSERT_TRUE(writer.start());
+    EXPECT_TRUE(mapper.waitForValues(-1, newValueNb).isSuccess());
+    EXPECT_GT(newValueNb, 0u);
+    writer.join();
+    EXPECT_EQ(int32_t(0), mapper.getMappedFile()[10]);
+
+    // Mapped files can not be followed
+    Mapper mapped(file.getName());
+    ASSERT_TRUE(mapped.map().isSuccess());
+    EXPECT_TRUE(mapped.follow().isFailure());
+}
@@ -0,0 +1,59 @@
+/**
+ * @section License
+ *
+ * Copyright 2014-2017 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/** Temporary file removed at destruction. */
+class TemporaryFile
+{
+public:
+    TemporaryFile() : mName("/tmp/utilities_test_XXXXXX")
+    {
+        int fd = mkstemp(&mName[0]);
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    ~TemporaryFile() { unlink(mName.c_str()); }
+
+    const char *getName() const { return mName.c_str(); }
+
+    /** Fill the file with the values [firstValue, firstValue + valueNb[ */
+    void fill(size_t valueNb, int32_t firstValue = 0) const
+    {
+        // One more value, for &values[0] to be valid when valueNb is 0
+        std::vector<int32_t> values(valueNb + 1);
+        for (size_t i = 0; i < valueNb; i++) {
+            values[i] = int32_t(firstValue + i);
+        }
+        FILE *file = fopen(mName.c_str(), "wb");
+        ASSERT_TRUE(file != NULL);
+        ASSERT_EQ(valueNb, fwrite(&values[0], sizeof(int32_t), valueNb, file));
+        fclose(file);
+    }
+
+private:
+    std::string mName;
+};